@@ -0,0 +1,158 @@
+/*
+  SVGMin - Aggressive SVG minifier
+
+  Copyright (C) 2009 Ariya Hidayat (ariya.hidayat@gmail.com)
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include "compression.h"
+
+#include <zlib.h>
+
+// window bits for deflateInit2/inflateInit2 which select the gzip wrapper
+static const int GzipWindowBits = 16 + MAX_WBITS;
+
+static const int ChunkSize = 16384;
+
+bool isGzipped(const QByteArray &data)
+{
+    return data.size() >= 2
+           && uchar(data.at(0)) == 0x1f
+           && uchar(data.at(1)) == 0x8b;
+}
+
+static QByteArray compressed(const QByteArray &data, int windowBits, int level, int strategy)
+{
+    z_stream stream;
+    stream.zalloc = Z_NULL;
+    stream.zfree = Z_NULL;
+    stream.opaque = Z_NULL;
+    if (deflateInit2(&stream, level, Z_DEFLATED, windowBits, 9, strategy) != Z_OK)
+        return QByteArray();
+
+    QByteArray result;
+    result.resize(int(deflateBound(&stream, data.size())) + 32);
+
+    stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data.constData()));
+    stream.avail_in = data.size();
+    stream.next_out = reinterpret_cast<Bytef *>(result.data());
+    stream.avail_out = result.size();
+
+    const int status = deflate(&stream, Z_FINISH);
+    const int written = int(stream.total_out);
+    deflateEnd(&stream);
+
+    if (status != Z_STREAM_END)
+        return QByteArray();
+
+    result.resize(written);
+    return result;
+}
+
+static QByteArray uncompressed(const QByteArray &data, int windowBits, bool *ok, int maximumSize)
+{
+    if (ok)
+        *ok = false;
+
+    z_stream stream;
+    stream.zalloc = Z_NULL;
+    stream.zfree = Z_NULL;
+    stream.opaque = Z_NULL;
+    stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data.constData()));
+    stream.avail_in = data.size();
+    if (inflateInit2(&stream, windowBits) != Z_OK)
+        return QByteArray();
+
+    QByteArray result;
+    int status = Z_OK;
+    while (status == Z_OK) {
+        // a byte beyond the maximum is enough to know that it is exceeded
+        const int offset = result.size();
+        if (maximumSize >= 0 && offset > maximumSize)
+            break;
+        int chunk = qMax(ChunkSize, data.size() * 2);
+        if (maximumSize >= 0)
+            chunk = qMin(chunk, maximumSize + 1 - offset);
+        result.resize(offset + chunk);
+        stream.next_out = reinterpret_cast<Bytef *>(result.data() + offset);
+        stream.avail_out = result.size() - offset;
+        status = inflate(&stream, Z_NO_FLUSH);
+        result.resize(result.size() - int(stream.avail_out));
+    }
+    inflateEnd(&stream);
+
+    if (status != Z_STREAM_END || (maximumSize >= 0 && result.size() > maximumSize))
+        return QByteArray();
+
+    if (ok)
+        *ok = true;
+    return result;
+}
+
+QByteArray gzipCompress(const QByteArray &data, int level)
+{
+    return compressed(data, GzipWindowBits, level, Z_DEFAULT_STRATEGY);
+}
+
+QByteArray gzipUncompress(const QByteArray &data, bool *ok)
+{
+    return uncompressed(data, GzipWindowBits, ok, -1);
+}
+
+QByteArray zlibCompress(const QByteArray &data, int level, bool filtered)
+{
+    return compressed(data, MAX_WBITS, level, filtered ? Z_FILTERED : Z_DEFAULT_STRATEGY);
+}
+
+QByteArray zlibUncompress(const QByteArray &data, bool *ok, int maximumSize)
+{
+    return uncompressed(data, MAX_WBITS, ok, maximumSize);
+}
+
+int deflatedSize(const QByteArray &data, int level)
+{
+    z_stream stream;
+    stream.zalloc = Z_NULL;
+    stream.zfree = Z_NULL;
+    stream.opaque = Z_NULL;
+    if (deflateInit2(&stream, level, Z_DEFLATED, -MAX_WBITS, 9,
+                     Z_DEFAULT_STRATEGY) != Z_OK)
+        return data.size();
+
+    stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data.constData()));
+    stream.avail_in = data.size();
+
+    char buffer[ChunkSize];
+    int status = Z_OK;
+    while (status == Z_OK) {
+        stream.next_out = reinterpret_cast<Bytef *>(buffer);
+        stream.avail_out = ChunkSize;
+        status = deflate(&stream, Z_FINISH);
+    }
+    const int size = int(stream.total_out);
+    deflateEnd(&stream);
+    return size;
+}
+
+quint32 crc32Checksum(const QByteArray &data)
+{
+    return quint32(crc32(crc32(0L, Z_NULL, 0),
+                         reinterpret_cast<const Bytef *>(data.constData()), data.size()));
+}
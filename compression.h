@@ -0,0 +1,51 @@
+/*
+  SVGMin - Aggressive SVG minifier
+
+  Copyright (C) 2009 Ariya Hidayat (ariya.hidayat@gmail.com)
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#ifndef COMPRESSION_H
+#define COMPRESSION_H
+
+#include <QtCore/QByteArray>
+
+// gzip (RFC 1952) helpers, used for .svgz documents
+QByteArray gzipCompress(const QByteArray &data, int level = 9);
+QByteArray gzipUncompress(const QByteArray &data, bool *ok = 0);
+
+// zlib (RFC 1950) helpers, used for the image data of PNG files; the
+// filtered strategy suits data which has gone through PNG filters, and
+// uncompressing fails once the result would exceed a maximum size which
+// is not negative
+QByteArray zlibCompress(const QByteArray &data, int level = 9, bool filtered = false);
+QByteArray zlibUncompress(const QByteArray &data, bool *ok = 0, int maximumSize = -1);
+
+// CRC-32 as used by gzip and PNG
+quint32 crc32Checksum(const QByteArray &data);
+
+// size of the raw deflate stream of the data, used to estimate the
+// effect of a change on the compressed document
+int deflatedSize(const QByteArray &data, int level = 9);
+
+// returns true if the data starts with the gzip magic bytes
+bool isGzipped(const QByteArray &data);
+
+#endif
@@ -0,0 +1,540 @@
+/*
+  SVGMin - Aggressive SVG minifier
+
+  Copyright (C) 2009 Ariya Hidayat (ariya.hidayat@gmail.com)
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include "cssminifier.h"
+
+#include <QtCore/QList>
+#include <QtCore/QStringList>
+
+#include "documentindex.h"
+#include "qcssparser_p.h"
+#include "svgcolor.h"
+
+using namespace QCss;
+
+enum CssContext {
+    SelectorContext,
+    ValueContext
+};
+
+struct CssRule
+{
+    CssRule() : atRule(false) {}
+    QString selector;
+    QString body;
+    bool atRule;
+};
+
+// the scanner stops at the first character it does not know, in that case
+// the symbols do not cover the whole input
+static bool coversInput(const QString &css, const QVector<Symbol> &symbols)
+{
+    int pos = 0;
+    foreach (const Symbol &symbol, symbols) {
+        if (symbol.start != pos || symbol.token == INVALID)
+            return false;
+        pos += symbol.len;
+    }
+    return pos == css.size();
+}
+
+// some punctuation tokens swallow the whitespace in front of them
+static bool hasLeadingSpace(const QString &css, const Symbol &symbol)
+{
+    switch (symbol.token) {
+    case LBRACE:
+    case PLUS:
+    case GREATER:
+    case COMMA:
+        return symbol.len > 1 && css.at(symbol.start).isSpace();
+    default:
+        return false;
+    }
+}
+
+static bool isLengthUnit(const QString &unit)
+{
+    static const char *units[] = { "px", "em", "ex", "pt", "pc", "cm", "mm", "in", 0 };
+    for (int i = 0; units[i]; ++i)
+        if (unit.compare(QLatin1String(units[i]), Qt::CaseInsensitive) == 0)
+            return true;
+    return false;
+}
+
+// "0.50px" -> ".5px", "0px" -> "0" unless the unit is needed, as it is
+// inside calc() and the other math functions
+static QString shortenNumber(const QString &text, bool keepUnit)
+{
+    int end = 0;
+    while (end < text.size() && (text.at(end).isDigit() || text.at(end) == '.'
+                                 || (end == 0 && (text.at(0) == '-' || text.at(0) == '+'))))
+        ++end;
+
+    QString number = text.left(end);
+    const QString unit = text.mid(end);
+    if (number.contains('e') || number.contains('E'))
+        return text;
+
+    QString sign;
+    if (number.startsWith('-') || number.startsWith('+')) {
+        sign = number.left(1);
+        number.remove(0, 1);
+    }
+
+    if (number.contains('.')) {
+        while (number.endsWith('0'))
+            number.chop(1);
+        if (number.endsWith('.'))
+            number.chop(1);
+    }
+    while (number.size() > 1 && number.startsWith('0') && number.at(1) != '.')
+        number.remove(0, 1);
+    if (number.startsWith("0."))
+        number.remove(0, 1);
+
+    if (number.isEmpty() || number == "0") {
+        if (unit.isEmpty() || (isLengthUnit(unit) && !keepUnit))
+            return "0";
+        return "0" + unit;
+    }
+
+    if (sign == "+")
+        sign.clear();
+    return sign + number + unit;
+}
+
+// "#FF0000" becomes "red", other hashes stay as they are
+static QString shortenHash(const QString &text)
+{
+    uint rgb;
+    if (!parseColor(QStringRef(&text), &rgb))
+        return text;
+    const QString color = colorText(rgb);
+    return color.size() <= text.size() ? color : text;
+}
+
+static bool spaceNeeded(TokenType previous, TokenType next, CssContext context)
+{
+    if (context == SelectorContext) {
+        switch (previous) {
+        case COMMA: case GREATER: case PLUS: case LBRACE:
+            return false;
+        default:
+            break;
+        }
+        switch (next) {
+        case COMMA: case GREATER: case PLUS: case LBRACE:
+            return false;
+        default:
+            return true;
+        }
+    }
+
+    switch (previous) {
+    case COMMA: case SLASH: case LPAREN: case FUNCTION: case COLON: case EXCLAMATION_SYM:
+        return false;
+    default:
+        break;
+    }
+    switch (next) {
+    case COMMA: case SLASH: case RPAREN: case SEMICOLON: case EXCLAMATION_SYM: case COLON:
+        return false;
+    default:
+        return true;
+    }
+}
+
+// where a zero length is not a plain 0, "calc(0px + 10%)" would be invalid
+static bool isMathFunction(const QStringRef &function)
+{
+    static const char *names[] = { "calc(", "min(", "max(", "clamp(", "-webkit-calc(", 0 };
+    for (int i = 0; names[i]; ++i)
+        if (function.compare(QLatin1String(names[i]), Qt::CaseInsensitive) == 0)
+            return true;
+    return false;
+}
+
+static QString tokenText(const QString &css, const Symbol &symbol, CssContext context, bool inMath)
+{
+    switch (symbol.token) {
+    case LBRACE:
+        return QString('{');
+    case PLUS:
+        return QString('+');
+    case GREATER:
+        return QString('>');
+    case COMMA:
+        return QString(',');
+    case NUMBER:
+    case LENGTH:
+    case PERCENTAGE:
+        if (context == ValueContext)
+            return shortenNumber(css.mid(symbol.start, symbol.len), inMath);
+        break;
+    case HASH:
+        if (context == ValueContext)
+            return shortenHash(css.mid(symbol.start, symbol.len));
+        break;
+    default:
+        break;
+    }
+    return css.mid(symbol.start, symbol.len);
+}
+
+// concatenates the symbols [from, to) keeping only significant whitespace
+static QString compact(const QString &css, const QVector<Symbol> &symbols,
+                       int from, int to, CssContext context)
+{
+    QString result;
+    TokenType previous = NONE;
+    bool pendingSpace = false;
+
+    // the nesting of parentheses, and that of the outermost math function
+    int depth = 0;
+    int mathDepth = 0;
+
+    for (int i = from; i < to; ++i) {
+        const Symbol &symbol = symbols.at(i);
+        if (symbol.token == S) {
+            pendingSpace = true;
+            continue;
+        }
+        if (hasLeadingSpace(css, symbol))
+            pendingSpace = true;
+        if (pendingSpace && previous != NONE && spaceNeeded(previous, symbol.token, context))
+            result += QLatin1Char(' ');
+        pendingSpace = false;
+
+        // url() arguments are copied verbatim
+        if (symbol.token == FUNCTION && css.midRef(symbol.start, symbol.len).startsWith(QLatin1String("url("), Qt::CaseInsensitive)) {
+            int end = i + 1;
+            while (end < to && symbols.at(end).token != RPAREN)
+                ++end;
+            const int last = qMin(end, to - 1);
+            result += css.mid(symbol.start, symbols.at(last).start + symbols.at(last).len - symbol.start);
+            i = last;
+            previous = symbols.at(last).token;
+            continue;
+        }
+
+        if (symbol.token == FUNCTION || symbol.token == LPAREN) {
+            ++depth;
+            if (!mathDepth && symbol.token == FUNCTION
+                && isMathFunction(css.midRef(symbol.start, symbol.len)))
+                mathDepth = depth;
+        } else if (symbol.token == RPAREN && depth > 0) {
+            if (depth == mathDepth)
+                mathDepth = 0;
+            --depth;
+        }
+
+        result += tokenText(css, symbol, context, mathDepth > 0);
+        previous = symbol.token;
+    }
+
+    return result;
+}
+
+// returns the index of the symbol matching the opening one at start
+static int matchingBrace(const QVector<Symbol> &symbols, int start, int end)
+{
+    int depth = 0;
+    for (int i = start; i < end; ++i) {
+        if (symbols.at(i).token == LBRACE)
+            ++depth;
+        else if (symbols.at(i).token == RBRACE && --depth == 0)
+            return i;
+    }
+    return -1;
+}
+
+static QString minifyDeclarations(const QString &css, const QVector<Symbol> &symbols,
+                                  int from, int to)
+{
+    QStringList declarations;
+
+    int start = from;
+    int depth = 0;
+    for (int i = from; i <= to; ++i) {
+        if (i < to) {
+            const TokenType token = symbols.at(i).token;
+            if (token == LPAREN || token == FUNCTION)
+                ++depth;
+            else if (token == RPAREN)
+                --depth;
+            if (token != SEMICOLON || depth > 0)
+                continue;
+        }
+
+        int colon = start;
+        while (colon < i && symbols.at(colon).token != COLON)
+            ++colon;
+
+        QString declaration;
+        if (colon < i)
+            declaration = compact(css, symbols, start, colon, SelectorContext).remove(' ')
+                          + QLatin1Char(':') + compact(css, symbols, colon + 1, i, ValueContext);
+        else
+            declaration = compact(css, symbols, start, i, ValueContext);
+
+        if (!declaration.isEmpty()) {
+            // an exact duplicate is redundant, keep the last occurrence
+            declarations.removeAll(declaration);
+            declarations += declaration;
+        }
+        start = i + 1;
+    }
+
+    return declarations.join(";");
+}
+
+// a selector can only match if every class and id it requires exists,
+// classes and ids inside functional pseudo classes like :not() are ignored
+static bool selectorMayMatch(const QString &css, const QVector<Symbol> &symbols,
+                             int from, int to, const DocumentIndex *index)
+{
+    int depth = 0;
+    for (int i = from; i < to; ++i) {
+        const Symbol &symbol = symbols.at(i);
+        switch (symbol.token) {
+        case LPAREN: case FUNCTION: case LBRACKET:
+            ++depth;
+            break;
+        case RPAREN: case RBRACKET:
+            --depth;
+            break;
+        case DOT:
+            if (depth == 0 && i + 1 < to && symbols.at(i + 1).token == IDENT) {
+                const Symbol &name = symbols.at(i + 1);
+                if (css.midRef(name.start, name.len).contains('\\'))
+                    break;
+                if (!index->classes.contains(name.lexem()))
+                    return false;
+            }
+            break;
+        case HASH:
+            if (depth == 0 && !css.midRef(symbol.start, symbol.len).contains('\\'))
+                if (!index->ids.contains(symbol.lexem().mid(1)))
+                    return false;
+            break;
+        default:
+            break;
+        }
+    }
+    return true;
+}
+
+static QString minifySelector(const QString &css, const QVector<Symbol> &symbols,
+                              int from, int to, const DocumentIndex *index)
+{
+    QStringList selectors;
+    int start = from;
+    int depth = 0;
+    for (int i = from; i <= to; ++i) {
+        if (i < to) {
+            const TokenType token = symbols.at(i).token;
+            if (token == LPAREN || token == FUNCTION || token == LBRACKET)
+                ++depth;
+            else if (token == RPAREN || token == RBRACKET)
+                --depth;
+            if (token != COMMA || depth > 0)
+                continue;
+        }
+        if (!index || selectorMayMatch(css, symbols, start, i, index)) {
+            const QString selector = compact(css, symbols, start, i, SelectorContext);
+            if (!selector.isEmpty() && !selectors.contains(selector))
+                selectors += selector;
+        }
+        start = i + 1;
+    }
+    return selectors.join(",");
+}
+
+// a browser drops the whole rule if one of its selectors is not understood,
+// so rules with vendor specific selectors are never combined
+static bool canCombineSelectors(const CssRule &rule)
+{
+    return !rule.selector.contains(QLatin1String(":-"));
+}
+
+static QString minifyRules(const QString &css, const DocumentIndex *index, bool *ok);
+
+static QList<CssRule> parseRules(const QString &css, const DocumentIndex *index, bool *ok)
+{
+    QList<CssRule> rules;
+
+    QVector<Symbol> symbols;
+    Scanner::scan(css, &symbols);
+    *ok = coversInput(css, symbols);
+    if (!*ok)
+        return rules;
+
+    const int count = symbols.count();
+    int i = 0;
+    while (i < count) {
+        const TokenType token = symbols.at(i).token;
+        if (token == S || token == CDO || token == CDC || token == SEMICOLON) {
+            ++i;
+            continue;
+        }
+
+        // find the end of the prelude
+        int end = i;
+        int depth = 0;
+        while (end < count) {
+            const TokenType t = symbols.at(end).token;
+            if (t == LPAREN || t == FUNCTION || t == LBRACKET)
+                ++depth;
+            else if (t == RPAREN || t == RBRACKET)
+                --depth;
+            else if (depth == 0 && (t == LBRACE || (t == SEMICOLON && token == ATKEYWORD_SYM)))
+                break;
+            ++end;
+        }
+        if (end == count) {
+            *ok = false;
+            return rules;
+        }
+
+        CssRule rule;
+        if (symbols.at(end).token == SEMICOLON) {
+            // statement at-rule, e.g. @import
+            rule.atRule = true;
+            rule.body = compact(css, symbols, i, end, ValueContext) + QLatin1Char(';');
+            rules += rule;
+            i = end + 1;
+            continue;
+        }
+
+        const int close = matchingBrace(symbols, end, count);
+        if (close < 0) {
+            *ok = false;
+            return rules;
+        }
+
+        if (token == ATKEYWORD_SYM) {
+            rule.atRule = true;
+            bool nested = false;
+            for (int j = end + 1; j < close && !nested; ++j)
+                nested = symbols.at(j).token == LBRACE;
+
+            QString block;
+            if (nested) {
+                const int start = symbols.at(end).start + symbols.at(end).len;
+                block = minifyRules(css.mid(start, symbols.at(close).start - start), index, ok);
+                if (!*ok)
+                    return rules;
+            } else {
+                block = minifyDeclarations(css, symbols, end + 1, close);
+            }
+            rule.body = compact(css, symbols, i, end, ValueContext)
+                        + QLatin1Char('{') + block + QLatin1Char('}');
+        } else {
+            rule.selector = minifySelector(css, symbols, i, end, index);
+            rule.body = minifyDeclarations(css, symbols, end + 1, close);
+        }
+
+        if (rule.atRule || (!rule.selector.isEmpty() && !rule.body.isEmpty()))
+            rules += rule;
+        i = close + 1;
+    }
+
+    return rules;
+}
+
+static QString minifyRules(const QString &css, const DocumentIndex *index, bool *ok)
+{
+    QList<CssRule> rules = parseRules(css, index, ok);
+    if (!*ok)
+        return css;
+
+    // an identical rule later on overrides the earlier one anyway
+    for (int i = rules.count() - 1; i > 0; --i) {
+        const CssRule rule = rules.at(i);
+        if (rule.atRule)
+            continue;
+        for (int j = i - 1; j >= 0; --j) {
+            const CssRule &other = rules.at(j);
+            if (!other.atRule && other.selector == rule.selector && other.body == rule.body) {
+                rules.removeAt(j);
+                --i;
+            }
+        }
+    }
+
+    // merge adjacent rules sharing the selector or the declarations
+    QString result;
+    CssRule current;
+    bool hasCurrent = false;
+    foreach (const CssRule &rule, rules) {
+        if (hasCurrent && !rule.atRule && !current.atRule) {
+            if (rule.selector == current.selector) {
+                current.body += QLatin1Char(';') + rule.body;
+                continue;
+            }
+            if (rule.body == current.body && canCombineSelectors(rule) && canCombineSelectors(current)) {
+                current.selector += QLatin1Char(',') + rule.selector;
+                continue;
+            }
+        }
+        if (hasCurrent)
+            result += current.atRule ? current.body : current.selector + QLatin1Char('{') + current.body + QLatin1Char('}');
+        current = rule;
+        hasCurrent = true;
+    }
+    if (hasCurrent)
+        result += current.atRule ? current.body : current.selector + QLatin1Char('{') + current.body + QLatin1Char('}');
+
+    return result;
+}
+
+QString minifyStyleSheet(const QString &css, const DocumentIndex *index)
+{
+    bool ok;
+    const QString result = minifyRules(css, index, &ok);
+    return ok ? result : css;
+}
+
+void collectStyleSheetProperties(const QString &css, QSet<QString> *properties)
+{
+    QVector<Symbol> symbols;
+    Scanner::scan(css, &symbols);
+
+    // an identifier followed by a colon inside a block
+    int depth = 0;
+    for (int i = 0; i < symbols.count(); ++i) {
+        const TokenType token = symbols.at(i).token;
+        if (token == LBRACE) {
+            ++depth;
+        } else if (token == RBRACE) {
+            --depth;
+        } else if (token == IDENT && depth > 0) {
+            int next = i + 1;
+            while (next < symbols.count() && symbols.at(next).token == S)
+                ++next;
+            if (next < symbols.count() && symbols.at(next).token == COLON)
+                properties->insert(symbols.at(i).lexem().toLower());
+        }
+    }
+}
@@ -0,0 +1,43 @@
+/*
+  SVGMin - Aggressive SVG minifier
+
+  Copyright (C) 2009 Ariya Hidayat (ariya.hidayat@gmail.com)
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#ifndef CSSMINIFIER_H
+#define CSSMINIFIER_H
+
+#include <QtCore/QSet>
+#include <QtCore/QString>
+
+class DocumentIndex;
+
+// Minifies the content of a <style> element: comments and whitespace are
+// stripped, numbers and colors shortened and duplicated rules merged.
+// If an index is given, selectors referring to a class or an id which does
+// not exist in the document are removed as well.
+// Style sheets which can not be tokenized are returned unchanged.
+QString minifyStyleSheet(const QString &css, const DocumentIndex *index = 0);
+
+// adds the names of all properties declared by the style sheet
+void collectStyleSheetProperties(const QString &css, QSet<QString> *properties);
+
+#endif
@@ -0,0 +1,673 @@
+/*
+  SVGMin - Aggressive SVG minifier
+
+  Copyright (C) 2009 Ariya Hidayat (ariya.hidayat@gmail.com)
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include "documentindex.h"
+
+#include <string.h>
+
+#include <QtCore/QMap>
+#include <QtCore/QStack>
+#include <QtCore/QStringList>
+#include <QtCore/QXmlStreamReader>
+
+#include "cssminifier.h"
+#include "eventstream.h"
+#include "qcssparser_p.h"
+#include "references.h"
+#include "svgproperties.h"
+#include "svgstyle.h"
+#include "transform.h"
+
+// a <use> element with a generated id costs about as much, smaller
+// repetitions stay as they are
+static const qint64 minimumSubtreeSize = 80;
+
+static const char xlinkNamespace[] = "http://www.w3.org/1999/xlink";
+
+DocumentIndex::DocumentIndex()
+    : findRepeatedSubtrees(false)
+    , mergeDefinitions(false)
+    , findUnusedDefinitions(false)
+    , findReferencedElements(false)
+    , findUsedPrefixes(false)
+    , removeMetadata(false)
+    , hasStyleSheet(false)
+    , hasScript(false)
+    , declareXlinkPrefix(false)
+    , usedPrefixes(0)
+{
+}
+
+bool DocumentIndex::isPrefixUsed(const QStringRef &prefix) const
+{
+    const int id = prefixIds.value(prefix.toString(), -1);
+    return id < 0 || id >= 64 || (usedPrefixes & (Q_UINT64_C(1) << id));
+}
+
+static void usePrefix(DocumentIndex *index, const QStringRef &prefix)
+{
+    if (prefix.isEmpty())
+        return;
+    const QString name = prefix.toString();
+    QHash<QString, int>::const_iterator it = index->prefixIds.constFind(name);
+    if (it == index->prefixIds.constEnd())
+        it = index->prefixIds.insert(name, index->prefixIds.count());
+    if (it.value() < 64)
+        index->usedPrefixes |= Q_UINT64_C(1) << it.value();
+}
+
+// FNV-1a over the UTF-16 code units, the length keeps "ab" "c" apart
+// from "a" "bc"
+static quint64 hashText(quint64 hash, const QStringRef &text)
+{
+    const QChar *unicode = text.unicode();
+    for (int i = 0; i < text.size(); ++i) {
+        hash ^= unicode[i].unicode();
+        hash *= Q_UINT64_C(1099511628211);
+    }
+    hash ^= quint64(text.size());
+    return hash * Q_UINT64_C(1099511628211);
+}
+
+static quint64 hashValue(quint64 hash, quint64 value)
+{
+    for (int i = 0; i < 8; ++i) {
+        hash ^= (value >> (i * 8)) & 0xff;
+        hash *= Q_UINT64_C(1099511628211);
+    }
+    return hash;
+}
+
+static quint64 hashNumber(quint64 hash, double value)
+{
+    quint64 bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return hashValue(hash, bits);
+}
+
+// an element open in the pre-scan, whose hash covers its start tag and
+// the hashes of the children seen so far
+struct OpenSubtree
+{
+    quint64 hash;
+    double tx;
+    double ty;
+    qint64 start;
+    bool referencable;
+    bool container;
+    bool hasId;
+    bool descendantIds;
+    bool definition;
+    QString id;
+    QString alias;
+
+    // the inherited properties set by the element and its ancestors, and
+    // by the ancestors alone
+    quint64 context;
+    quint64 parentContext;
+
+    // for a definition, its attributes apart from the id and the href
+    QMap<QString, QString> attributes;
+};
+
+// a definition which is kept, for the ones merged into it
+struct KeptDefinition
+{
+    QString name;
+    quint64 parentContext;
+    QMap<QString, QString> attributes;
+};
+
+// the hash of a closed subtree, without the translation of its root
+struct Subtree
+{
+    quint64 hash;
+    double tx;
+    double ty;
+    bool candidate;
+};
+
+// what a <use> element may refer to, only in rendered content which does
+// not depend on the structure as the content of a <switch> does
+static bool isReferencable(const QStringRef &name)
+{
+    static const char *const names[] = {
+        "circle", "ellipse", "g", "image", "line", "path", "polygon",
+        "polyline", "rect", "text", "use"
+    };
+    for (unsigned i = 0; i < sizeof(names) / sizeof(names[0]); ++i)
+        if (name == QLatin1String(names[i]))
+            return true;
+    return false;
+}
+
+// paint servers and other resources which are the same wherever they are
+// used, merged when they are equal apart from their id
+static bool isDefinition(const QStringRef &name)
+{
+    static const char *const names[] = {
+        "clipPath", "filter", "linearGradient", "mask", "pattern", "radialGradient"
+    };
+    for (unsigned i = 0; i < sizeof(names) / sizeof(names[0]); ++i)
+        if (name == QLatin1String(names[i]))
+            return true;
+    return false;
+}
+
+// what is not rendered by itself but only through a reference, as the
+// children of <defs> apart from style sheets, scripts and fonts which
+// apply by name
+static bool isResource(const QStringRef &name, bool inDefs)
+{
+    static const char *const resources[] = {
+        "clipPath", "filter", "linearGradient", "marker", "mask", "pattern",
+        "radialGradient", "symbol"
+    };
+    static const char *const global[] = {
+        "color-profile", "font", "font-face", "script", "style"
+    };
+    if (inDefs) {
+        for (unsigned i = 0; i < sizeof(global) / sizeof(global[0]); ++i)
+            if (name == QLatin1String(global[i]))
+                return false;
+        return true;
+    }
+    for (unsigned i = 0; i < sizeof(resources) / sizeof(resources[0]); ++i)
+        if (name == QLatin1String(resources[i]))
+            return true;
+    return false;
+}
+
+static bool isAnimation(const QStringRef &name)
+{
+    static const char *const names[] = {
+        "animate", "animateColor", "animateMotion", "animateTransform", "set"
+    };
+    for (unsigned i = 0; i < sizeof(names) / sizeof(names[0]); ++i)
+        if (name == QLatin1String(names[i]))
+            return true;
+    return false;
+}
+
+static bool isPlainContainer(const QStringRef &name)
+{
+    return name == QLatin1String("svg") || name == QLatin1String("g") || name == QLatin1String("a");
+}
+
+// short ids which do not collide with those of the document
+static QString newId(const QSet<QString> &ids, int *counter)
+{
+    static const char letters[] = "abcdefghijklmnopqrstuvwxyz0123456789";
+    for (;;) {
+        int number = (*counter)++;
+        QString id(QLatin1Char(letters[number % 26]));
+        for (number /= 26; number > 0; number = (number - 1) / 36)
+            id += QLatin1Char(letters[(number - 1) % 36]);
+        if (!ids.contains(id))
+            return id;
+    }
+}
+
+// A definition is the outermost resource element, every id in its subtree
+// leads to it. The edges go from the definition which contains a
+// reference, or from the rendered content for -1, to the id.
+struct ReferenceGraph
+{
+    QVector<int> definitions;
+    QHash<QString, int> ids;
+    QVector<QPair<int, QString> > edges;
+};
+
+// marks the definitions which can not be reached from the rendered content
+static void markUnusedDefinitions(DocumentIndex *index, const ReferenceGraph &graph)
+{
+    QVector<QVector<int> > targets(graph.definitions.count());
+    QVector<bool> used(graph.definitions.count(), false);
+    QStack<int> pending;
+
+    for (int i = 0; i < graph.edges.count(); ++i) {
+        const QString &id = graph.edges.at(i).second;
+        const int target = graph.ids.value(index->mergedIds.value(id, id), -1);
+        if (target < 0)
+            continue;
+        const int source = graph.edges.at(i).first;
+        if (source >= 0) {
+            targets[source].append(target);
+        } else if (!used.at(target)) {
+            used[target] = true;
+            pending.push(target);
+        }
+    }
+
+    while (!pending.isEmpty()) {
+        const int definition = pending.pop();
+        foreach (int target, targets.at(definition)) {
+            if (!used.at(target)) {
+                used[target] = true;
+                pending.push(target);
+            }
+        }
+    }
+
+    for (int i = 0; i < graph.definitions.count(); ++i)
+        if (!used.at(i))
+            index->elements[graph.definitions.at(i)].flags |= DocumentIndex::Element::Unused;
+}
+
+// in document order, the first occurrence of a repeated subtree gets an
+// id and the later ones refer to it, nested repetitions go along with
+// their ancestor
+static void chooseReferences(DocumentIndex *index, const QVector<Subtree> &subtrees)
+{
+    QHash<quint64, int> counts;
+    foreach (const Subtree &subtree, subtrees)
+        if (subtree.candidate)
+            ++counts[subtree.hash];
+
+    QHash<quint64, int> firsts;
+    int counter = 0;
+    for (int i = 0; i < subtrees.count(); ++i) {
+        const Subtree &subtree = subtrees.at(i);
+        if (!subtree.candidate || counts.value(subtree.hash) < 2)
+            continue;
+        const QHash<quint64, int>::const_iterator first = firsts.constFind(subtree.hash);
+        if (first == firsts.constEnd()) {
+            firsts.insert(subtree.hash, i);
+            index->generatedIds.insert(i, newId(index->ids, &counter));
+            index->elements[i].flags |= DocumentIndex::Element::HasId | DocumentIndex::Element::Reused;
+        } else {
+            DocumentIndex::Reference reference;
+            reference.id = index->generatedIds.value(first.value());
+            reference.dx = subtree.tx - subtrees.at(first.value()).tx;
+            reference.dy = subtree.ty - subtrees.at(first.value()).ty;
+            index->references.insert(i, reference);
+        }
+        i += index->elements.at(i).descendantCount;
+    }
+}
+
+static void collectStyleSheetIds(const QString &css, QSet<QString> *ids)
+{
+    QVector<QCss::Symbol> symbols;
+    QCss::Scanner::scan(css, &symbols);
+    foreach (const QCss::Symbol &symbol, symbols)
+        if (symbol.token == QCss::HASH)
+            ids->insert(symbol.lexem().mid(1));
+}
+
+bool DocumentIndex::scan(const QByteArray &document)
+{
+    QXmlStreamReader xml(document);
+    xml.setNamespaceProcessing(false);
+    return scanTokens(xml);
+}
+
+bool DocumentIndex::scan(const EventStream *events)
+{
+    EventStreamReader reader(events);
+    return scanTokens(reader);
+}
+
+template <typename Reader>
+bool DocumentIndex::scanTokens(Reader &xml)
+{
+    bool inStyleSheet = false;
+    QString styleSheet;
+
+    QStack<int> openElements;
+
+    // Merkle hashes of every subtree, from the end tags up
+    const bool hashSubtrees = findRepeatedSubtrees || mergeDefinitions;
+    QStack<OpenSubtree> openSubtrees;
+    QVector<Subtree> subtrees;
+
+    // the first definition with each hash, with the inherited properties
+    // of its ancestors, and every definition which is kept, by id
+    QHash<quint64, QString> definitionHashes;
+    QHash<QString, KeptDefinition> keptDefinitions;
+    QVector<int> merged;
+    QString remapped;
+
+    // the definition the current element belongs to, if any
+    ReferenceGraph graph;
+    QStack<bool> openDefs;
+    int definition = -1;
+    int definitionDepth = 0;
+    QStringList referencedIds;
+
+    // every referenced id, and the elements with an id
+    QSet<QString> referenced;
+    QVector<QPair<int, QString> > elementIds;
+
+    // every namespace prefix, and those declared below the root element
+    // which could bind the XLink prefix to another namespace there
+    QSet<QString> declaredPrefixes;
+    QSet<QString> innerPrefixes;
+
+    // elements which the minifying pass skips, with everything inside
+    QStringList editorPrefixes;
+    QStack<bool> skipped;
+
+    while (!xml.atEnd()) {
+        const qint64 offset = xml.characterOffset();
+        switch (xml.readNext()) {
+
+        case QXmlStreamReader::StartElement: {
+            const QXmlStreamAttributes attr = xml.attributes();
+
+            // only a prefix of the root element is in scope everywhere
+            const bool root = openElements.isEmpty();
+            foreach (const QXmlStreamAttribute &a, attr) {
+                if (a.prefix() != QLatin1String("xmlns"))
+                    continue;
+                declaredPrefixes.insert(a.name().toString());
+                if (!root)
+                    innerPrefixes.insert(a.name().toString());
+                else if (xlinkPrefix.isEmpty() && a.value() == QLatin1String(xlinkNamespace))
+                    xlinkPrefix = a.name().toString();
+            }
+
+            const QStringRef id = attr.value("id");
+            if (!id.isEmpty())
+                ids.insert(id.toString());
+
+            if (!openElements.isEmpty())
+                ++elements[openElements.top()].childCount;
+            Element element;
+            element.childCount = 0;
+            element.descendantCount = 0;
+            element.flags = 0;
+            if (!id.isEmpty())
+                element.flags |= Element::HasId;
+            if (isTransformable(xml.name()))
+                element.flags |= Element::Transformable;
+            openElements.push(elements.count());
+            elements.append(element);
+
+            if (xml.name() == "script")
+                hasScript = true;
+
+            if (findUsedPrefixes) {
+                if (xml.name() == "svg")
+                    foreach (const QXmlStreamAttribute &a, attr)
+                        if (a.prefix() == QLatin1String("xmlns") && editorNamespaces.contains(a.value().toString()))
+                            editorPrefixes += a.name().toString();
+                bool skip = !skipped.isEmpty() && skipped.top();
+                skip = skip || editorPrefixes.contains(xml.prefix().toString());
+                skip = skip || (removeMetadata && xml.name() == "metadata");
+                skipped.push(skip);
+                if (!skip) {
+                    usePrefix(this, xml.prefix());
+                    foreach (const QXmlStreamAttribute &a, attr)
+                        if (a.prefix() != QLatin1String("xmlns") && !editorPrefixes.contains(a.prefix().toString()))
+                            usePrefix(this, a.prefix());
+                }
+            }
+
+            if (findUnusedDefinitions || findReferencedElements) {
+                referencedIds.clear();
+                foreach (const QXmlStreamAttribute &a, attr)
+                    collectReferences(a.value(), isHref(a.qualifiedName()), &referencedIds);
+            }
+
+            if (findUnusedDefinitions) {
+                const bool inDefs = !openDefs.isEmpty() && openDefs.top();
+                openDefs.push(xml.qualifiedName() == QLatin1String("defs"));
+                if (definition < 0 && isResource(xml.qualifiedName(), inDefs)) {
+                    definition = graph.definitions.count();
+                    definitionDepth = openElements.count();
+                    graph.definitions.append(openElements.top());
+                }
+                if (definition >= 0 && !id.isEmpty())
+                    graph.ids.insert(id.toString(), definition);
+                foreach (const QString &reference, referencedIds)
+                    graph.edges.append(qMakePair(definition, reference));
+            }
+
+            if (findReferencedElements) {
+                foreach (const QString &reference, referencedIds)
+                    referenced.insert(reference);
+                if (!id.isEmpty())
+                    elementIds.append(qMakePair(openElements.top(), id.toString()));
+                if (isAnimation(xml.name()))
+                    elements.last().flags |= Element::Animation;
+            }
+
+            if (hashSubtrees) {
+                const bool inContainer = openSubtrees.isEmpty() || openSubtrees.top().container;
+                OpenSubtree subtree;
+                subtree.hash = hashText(Q_UINT64_C(14695981039346656037), xml.qualifiedName());
+                subtree.tx = 0;
+                subtree.ty = 0;
+                subtree.start = offset;
+                subtree.referencable = inContainer && isReferencable(xml.qualifiedName());
+                subtree.container = inContainer && isPlainContainer(xml.qualifiedName());
+                subtree.hasId = !id.isEmpty();
+                subtree.descendantIds = false;
+                subtree.definition = mergeDefinitions && !id.isEmpty() && isDefinition(xml.qualifiedName());
+                if (subtree.definition)
+                    subtree.id = id.toString();
+                subtree.parentContext = openSubtrees.isEmpty() ? 0 : openSubtrees.top().context;
+                subtree.context = subtree.parentContext;
+                foreach (const QXmlStreamAttribute &a, attr) {
+                    // what the children inherit, conservatively by the text
+                    if (a.qualifiedName() == QLatin1String("style")) {
+                        subtree.context = hashText(hashText(subtree.context, a.name()), a.value());
+                    } else if (a.prefix().isEmpty()) {
+                        const SvgProperty *property = findProperty(a.name());
+                        if (property && (property->flags & SvgProperty::Inherited))
+                            subtree.context = hashText(hashText(subtree.context, a.name()), a.value());
+                    }
+                    if (subtree.definition && a.qualifiedName() == QLatin1String("id"))
+                        continue;
+                    Transform transform;
+                    if (a.qualifiedName() == QLatin1String("transform")
+                        && parseTransform(a.value(), &transform) && transform.isTranslation()) {
+                        subtree.tx = transform.e;
+                        subtree.ty = transform.f;
+                        if (subtree.definition)
+                            subtree.attributes.insert(a.qualifiedName().toString(), a.value().toString());
+                        continue;
+                    }
+                    subtree.hash = hashText(subtree.hash, a.qualifiedName());
+                    // references to merged definitions compare equal
+                    const bool remap = !mergedIds.isEmpty()
+                        && remapReferences(a.value(), isHref(a.qualifiedName()), mergedIds, &remapped);
+                    const QStringRef value = remap ? QStringRef(&remapped) : a.value();
+                    subtree.hash = hashText(subtree.hash, value);
+                    if (subtree.definition) {
+                        // a gradient, pattern or filter based on another one
+                        if (isHref(a.qualifiedName()) && a.value().startsWith(QLatin1Char('#')))
+                            subtree.alias = a.value().toString().mid(1);
+                        else
+                            subtree.attributes.insert(a.qualifiedName().toString(), value.toString());
+                    }
+                }
+                openSubtrees.push(subtree);
+            }
+
+            const QStringRef classNames = attr.value("class");
+            if (!classNames.isEmpty())
+                foreach (const QString &name, classNames.toString().simplified().split(' '))
+                    classes.insert(name);
+
+            const QStringRef style = attr.value("style");
+            if (!style.isEmpty())
+                ++styleCounts[styleText(normalizedStyle(parseStyle(style)))];
+
+            if (xml.name() == "style") {
+                hasStyleSheet = true;
+                inStyleSheet = true;
+                styleSheet.clear();
+            }
+            break;
+        }
+
+        case QXmlStreamReader::EndElement: {
+            if (findUsedPrefixes)
+                skipped.pop();
+            if (findUnusedDefinitions) {
+                openDefs.pop();
+                if (openElements.count() == definitionDepth)
+                    definition = -1;
+            }
+            const int number = openElements.pop();
+            elements[number].descendantCount = elements.count() - number - 1;
+            if (hashSubtrees) {
+                const OpenSubtree open = openSubtrees.pop();
+                Subtree subtree;
+                subtree.hash = open.hash;
+                subtree.tx = open.tx;
+                subtree.ty = open.ty;
+                subtree.candidate = open.referencable && !open.hasId
+                    && xml.characterOffset() - open.start >= minimumSubtreeSize;
+                subtrees.resize(elements.count());
+                subtrees[number] = subtree;
+                const quint64 hash = hashNumber(hashNumber(open.hash, open.tx), open.ty);
+                if (!openSubtrees.isEmpty()) {
+                    OpenSubtree &parent = openSubtrees.top();
+                    parent.hash = hashValue(parent.hash, hash);
+                    parent.hasId = parent.hasId || open.hasId;
+                    parent.descendantIds = parent.descendantIds || open.hasId;
+                }
+
+                // Dropping a definition must not drop other ids with it.
+                // The inherited properties of the ancestors, which could
+                // be used through "currentColor" or "inherit", have to be
+                // the same as well.
+                if (open.definition && !open.descendantIds) {
+                    QString target;
+                    if (!open.alias.isEmpty() && elements.at(number).descendantCount == 0) {
+                        // the same as the one it is based on if its own
+                        // attributes do not change anything there
+                        target = mergedIds.value(open.alias, open.alias);
+                        const KeptDefinition kept = keptDefinitions.value(target);
+                        bool same = kept.name == xml.qualifiedName()
+                            && kept.parentContext == open.parentContext;
+                        if (same) {
+                            QMap<QString, QString> attributes = kept.attributes;
+                            QMap<QString, QString>::const_iterator it;
+                            for (it = open.attributes.constBegin(); it != open.attributes.constEnd(); ++it)
+                                attributes.insert(it.key(), it.value());
+                            same = attributes == kept.attributes;
+                        }
+                        if (!same)
+                            target.clear();
+                    }
+                    if (target.isEmpty()) {
+                        const quint64 key = hashValue(hash, open.parentContext);
+                        target = definitionHashes.value(key);
+                        if (target.isEmpty())
+                            definitionHashes.insert(key, open.id);
+                    }
+                    if (target.isEmpty() || target == open.id) {
+                        KeptDefinition kept;
+                        kept.name = xml.qualifiedName().toString();
+                        kept.parentContext = open.parentContext;
+                        kept.attributes = open.attributes;
+                        keptDefinitions.insert(open.id, kept);
+                    } else {
+                        mergedIds.insert(open.id, target);
+                        merged.append(number);
+                    }
+                }
+            }
+            if (inStyleSheet) {
+                // rules apply to the whole document
+                if (findUnusedDefinitions) {
+                    referencedIds.clear();
+                    collectReferences(QStringRef(&styleSheet), false, &referencedIds);
+                    foreach (const QString &reference, referencedIds)
+                        graph.edges.append(qMakePair(-1, reference));
+                }
+                collectStyleSheetIds(styleSheet, &styleSheetIds);
+                collectStyleSheetProperties(styleSheet, &styleSheetProperties);
+                inStyleSheet = false;
+            }
+            break;
+        }
+
+        case QXmlStreamReader::Characters:
+            if (inStyleSheet)
+                styleSheet += xml.text();
+            // indentation differs with the depth and is not rendered
+            if (hashSubtrees && !openSubtrees.isEmpty()) {
+                OpenSubtree &parent = openSubtrees.top();
+                parent.hash = xml.isWhitespace() ? hashValue(parent.hash, ' ')
+                                                 : hashText(parent.hash, xml.text());
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    // a style sheet rule could match the repetitions but not the reused
+    // subtree, or the other way round
+    if (findRepeatedSubtrees && !hasStyleSheet && !xml.hasError())
+        chooseReferences(this, subtrees);
+
+    // the <use> elements for the repetitions link with it, a prefix the
+    // root element does not bind yet is declared there
+    if (innerPrefixes.contains(xlinkPrefix))
+        xlinkPrefix.clear();
+    if (!references.isEmpty()) {
+        if (xlinkPrefix.isEmpty()) {
+            xlinkPrefix = QLatin1String("xlink");
+            for (int i = 1; declaredPrefixes.contains(xlinkPrefix); ++i)
+                xlinkPrefix = QLatin1String("xlink") + QString::number(i);
+            declareXlinkPrefix = true;
+        } else {
+            usePrefix(this, QStringRef(&xlinkPrefix));
+        }
+    }
+
+    // style sheets and scripts could refer to the merged ids
+    if (hasStyleSheet || hasScript || xml.hasError())
+        mergedIds.clear();
+    else
+        foreach (int number, merged)
+            elements[number].flags |= Element::Merged;
+
+    // a reference to a merged definition is one to the definition kept
+    if (findReferencedElements) {
+        foreach (const QString &id, referenced)
+            if (mergedIds.contains(id))
+                referenced.insert(mergedIds.value(id));
+        for (int i = 0; i < elementIds.count(); ++i)
+            if (referenced.contains(elementIds.at(i).second))
+                elements[elementIds.at(i).first].flags |= Element::Referenced;
+    }
+
+    // only scripts could still refer to other ids, a selector by id
+    // keeps its element
+    if (findUnusedDefinitions && !hasScript && !xml.hasError()) {
+        foreach (const QString &id, styleSheetIds)
+            graph.edges.append(qMakePair(-1, id));
+        markUnusedDefinitions(this, graph);
+    }
+
+    return !xml.hasError();
+}
@@ -0,0 +1,133 @@
+/*
+  SVGMin - Aggressive SVG minifier
+
+  Copyright (C) 2009 Ariya Hidayat (ariya.hidayat@gmail.com)
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#ifndef DOCUMENTINDEX_H
+#define DOCUMENTINDEX_H
+
+#include <QtCore/QByteArray>
+#include <QtCore/QHash>
+#include <QtCore/QSet>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QVector>
+
+class EventStream;
+
+// Facts about a whole document, collected in a pre-scan before the
+// minifying pass for those stages which cannot decide on the fly.
+class DocumentIndex
+{
+public:
+    DocumentIndex();
+
+    // set before the scan to look for repeated subtrees, for duplicate
+    // definitions and for definitions which nothing refers to
+    bool findRepeatedSubtrees;
+    bool mergeDefinitions;
+    bool findUnusedDefinitions;
+
+    // set before the scan to flag elements which are referenced or animated
+    bool findReferencedElements;
+
+    // set before the scan to find the namespace prefixes which are still
+    // used once the editor data, and maybe the metadata, is removed
+    bool findUsedPrefixes;
+    QStringList editorNamespaces;
+    bool removeMetadata;
+
+    bool scan(const QByteArray &document);
+
+    // the same for a recorded document, see eventstream.h
+    bool scan(const EventStream *events);
+
+    // every class name and id used by an element
+    QSet<QString> classes;
+    QSet<QString> ids;
+
+    // ids and properties which are mentioned in a <style> element
+    QSet<QString> styleSheetIds;
+    QSet<QString> styleSheetProperties;
+
+    // how often each normalized "style" attribute value occurs
+    QHash<QString, int> styleCounts;
+
+    bool hasStyleSheet;
+    bool hasScript;
+
+    // the prefix the root element binds to the XLink namespace, empty if
+    // there is none; with repetitions to reference one is always chosen,
+    // which the root element has to declare if declareXlinkPrefix is set
+    QString xlinkPrefix;
+    bool declareXlinkPrefix;
+
+    // a bit for each namespace prefix, by the order of appearance, set if
+    // the prefix is used; prefixes after the first 64 count as used
+    QHash<QString, int> prefixIds;
+    quint64 usedPrefixes;
+
+    bool isPrefixUsed(const QStringRef &prefix) const;
+
+    struct Element
+    {
+        enum Flag {
+            HasId = 1,
+            Transformable = 2,
+            Reused = 4,
+            Merged = 8,
+            Unused = 16,
+            Referenced = 32,
+            Animation = 64
+        };
+
+        int childCount;
+        int descendantCount;
+        int flags;
+    };
+
+    // every element in document order, the first child of an element is
+    // the one which follows it
+    QVector<Element> elements;
+
+    // a subtree which repeats an earlier one, apart from the translation
+    struct Reference
+    {
+        QString id;
+        double dx;
+        double dy;
+    };
+
+    // by element number, the generated ids of the reused subtrees and the
+    // repetitions which become <use> elements
+    QHash<int, QString> generatedIds;
+    QHash<int, Reference> references;
+
+    // the ids of definitions which duplicate or merely link to another
+    // one, and the id of that one
+    QHash<QString, QString> mergedIds;
+
+private:
+    template <typename Reader> bool scanTokens(Reader &xml);
+};
+
+#endif
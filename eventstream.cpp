@@ -0,0 +1,340 @@
+/*
+  SVGMin - Aggressive SVG minifier
+
+  Copyright (C) 2009 Ariya Hidayat (ariya.hidayat@gmail.com)
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include "eventstream.h"
+
+static const char magic[] = "SVGE";
+static const int magicSize = 4;
+static const char version = 1;
+
+// a string longer than that in the table is a corrupt stream
+static const quint64 maximumLength = 0x7fffffff;
+
+enum CharactersFlag {
+    CDATA = 1,
+    Whitespace = 2
+};
+
+static void appendNumber(QByteArray *data, quint64 number)
+{
+    while (number >= 0x80) {
+        data->append(char(number | 0x80));
+        number >>= 7;
+    }
+    data->append(char(number));
+}
+
+// false when the data ends in the middle of the number
+static bool readNumber(const QByteArray &data, int *position, quint64 *number)
+{
+    *number = 0;
+    for (int shift = 0; shift < 64 && *position < data.size(); shift += 7) {
+        const uchar byte = uchar(data.at((*position)++));
+        *number |= quint64(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+            return true;
+    }
+    return false;
+}
+
+bool EventStream::isEventStream(const QByteArray &data)
+{
+    return data.size() > magicSize && data.startsWith(QByteArray(magic, magicSize));
+}
+
+bool EventStream::load(const QByteArray &data)
+{
+    strings.clear();
+    tokens.clear();
+
+    if (!isEventStream(data) || data.at(magicSize) != version)
+        return false;
+
+    int position = magicSize + 1;
+    quint64 count;
+    if (!readNumber(data, &position, &count) || count > quint64(data.size()))
+        return false;
+    strings.reserve(int(count));
+    for (quint64 i = 0; i < count; ++i) {
+        quint64 length;
+        if (!readNumber(data, &position, &length) || length > maximumLength
+            || length > quint64(data.size() - position)) {
+            strings.clear();
+            return false;
+        }
+        strings += QString::fromUtf8(data.constData() + position, int(length));
+        position += int(length);
+    }
+
+    tokens = data.mid(position);
+    return true;
+}
+
+EventStreamReader::EventStreamReader(const EventStream *stream)
+    : stream(stream)
+    , position(0)
+    , type(QXmlStreamReader::NoToken)
+    , error(false)
+    , offset(0)
+    , first(0)
+    , second(0)
+    , colon(-1)
+    , standalone(false)
+    , cdata(false)
+    , whitespace(false)
+{
+}
+
+bool EventStreamReader::atEnd() const
+{
+    return type == QXmlStreamReader::EndDocument || type == QXmlStreamReader::Invalid;
+}
+
+quint64 EventStreamReader::readNumber()
+{
+    quint64 number;
+    if (!::readNumber(stream->tokens, &position, &number))
+        error = true;
+    return number;
+}
+
+const QString *EventStreamReader::readString()
+{
+    const quint64 number = readNumber();
+    if (number >= quint64(stream->strings.size())) {
+        error = true;
+        return 0;
+    }
+    return &stream->strings.at(int(number));
+}
+
+QXmlStreamReader::TokenType EventStreamReader::readNext()
+{
+    if (atEnd())
+        return type;
+
+    first = 0;
+    second = 0;
+    colon = -1;
+    attributeList.clear();
+
+    // the end of the stream before the end of the document
+    if (position >= stream->tokens.size()) {
+        error = true;
+        type = QXmlStreamReader::Invalid;
+        return type;
+    }
+
+    type = QXmlStreamReader::TokenType(uchar(stream->tokens.at(position++)));
+    offset += qint64(readNumber());
+
+    switch (type) {
+    case QXmlStreamReader::StartDocument:
+        first = readString();
+        standalone = position < stream->tokens.size() && stream->tokens.at(position++);
+        break;
+    case QXmlStreamReader::EndDocument:
+        break;
+    case QXmlStreamReader::StartElement: {
+        first = readString();
+        const quint64 count = readNumber();
+        for (quint64 i = 0; i < count && !error; ++i) {
+            const QString *attributeName = readString();
+            const QString *value = readString();
+            if (attributeName && value)
+                attributeList.append(*attributeName, *value);
+        }
+        if (first)
+            colon = first->indexOf(QLatin1Char(':'));
+        break;
+    }
+    case QXmlStreamReader::EndElement:
+        first = readString();
+        if (first)
+            colon = first->indexOf(QLatin1Char(':'));
+        break;
+    case QXmlStreamReader::Characters: {
+        first = readString();
+        const int flags = int(readNumber());
+        cdata = flags & CDATA;
+        whitespace = flags & Whitespace;
+        break;
+    }
+    case QXmlStreamReader::ProcessingInstruction:
+        first = readString();
+        second = readString();
+        break;
+    default:
+        // an Invalid token records a document which is not well-formed
+        error = true;
+        break;
+    }
+
+    if (error)
+        type = QXmlStreamReader::Invalid;
+    return type;
+}
+
+QStringRef EventStreamReader::ref(QXmlStreamReader::TokenType expected,
+                                  const QString *string) const
+{
+    if (type != expected || !string)
+        return QStringRef();
+    return QStringRef(string);
+}
+
+QStringRef EventStreamReader::documentVersion() const
+{
+    return ref(QXmlStreamReader::StartDocument, first);
+}
+
+QStringRef EventStreamReader::qualifiedName() const
+{
+    if ((type != QXmlStreamReader::StartElement && type != QXmlStreamReader::EndElement) || !first)
+        return QStringRef();
+    return QStringRef(first);
+}
+
+QStringRef EventStreamReader::prefix() const
+{
+    if (qualifiedName().isNull() || colon < 0)
+        return QStringRef();
+    return QStringRef(first, 0, colon);
+}
+
+QStringRef EventStreamReader::name() const
+{
+    if (qualifiedName().isNull())
+        return QStringRef();
+    return QStringRef(first, colon + 1, first->size() - colon - 1);
+}
+
+QStringRef EventStreamReader::text() const
+{
+    return ref(QXmlStreamReader::Characters, first);
+}
+
+QStringRef EventStreamReader::processingInstructionTarget() const
+{
+    return ref(QXmlStreamReader::ProcessingInstruction, first);
+}
+
+QStringRef EventStreamReader::processingInstructionData() const
+{
+    return ref(QXmlStreamReader::ProcessingInstruction, second);
+}
+
+EventStreamWriter::EventStreamWriter()
+    : offset(0)
+{
+}
+
+void EventStreamWriter::appendString(const QStringRef &string)
+{
+    const QString text = string.toString();
+    QHash<QString, int>::const_iterator it = numbers.constFind(text);
+    if (it == numbers.constEnd()) {
+        it = numbers.insert(text, strings.count());
+        strings += text;
+    }
+    appendNumber(&tokens, quint64(it.value()));
+}
+
+void EventStreamWriter::record(const QXmlStreamReader *xml)
+{
+    const QXmlStreamReader::TokenType type = xml->tokenType();
+    switch (type) {
+    case QXmlStreamReader::Invalid:
+    case QXmlStreamReader::StartDocument:
+    case QXmlStreamReader::EndDocument:
+    case QXmlStreamReader::StartElement:
+    case QXmlStreamReader::EndElement:
+    case QXmlStreamReader::Characters:
+    case QXmlStreamReader::ProcessingInstruction:
+        break;
+    default:
+        // nothing which the minifier writes
+        return;
+    }
+
+    tokens.append(char(type));
+    appendNumber(&tokens, quint64(qMax(Q_INT64_C(0), xml->characterOffset() - offset)));
+    offset = qMax(offset, xml->characterOffset());
+
+    switch (type) {
+    case QXmlStreamReader::StartDocument:
+        appendString(xml->documentVersion());
+        tokens.append(char(xml->isStandaloneDocument()));
+        break;
+    case QXmlStreamReader::StartElement: {
+        appendString(xml->qualifiedName());
+        const QXmlStreamAttributes attributes = xml->attributes();
+        appendNumber(&tokens, quint64(attributes.count()));
+        foreach (const QXmlStreamAttribute &attribute, attributes) {
+            appendString(attribute.qualifiedName());
+            appendString(attribute.value());
+        }
+        break;
+    }
+    case QXmlStreamReader::EndElement:
+        appendString(xml->qualifiedName());
+        break;
+    case QXmlStreamReader::Characters:
+        appendString(xml->text());
+        appendNumber(&tokens, (xml->isCDATA() ? CDATA : 0) | (xml->isWhitespace() ? Whitespace : 0));
+        break;
+    case QXmlStreamReader::ProcessingInstruction:
+        appendString(xml->processingInstructionTarget());
+        appendString(xml->processingInstructionData());
+        break;
+    default:
+        break;
+    }
+}
+
+QByteArray EventStreamWriter::data() const
+{
+    QByteArray result(magic, magicSize);
+    result.append(version);
+    appendNumber(&result, quint64(strings.count()));
+    foreach (const QString &string, strings) {
+        const QByteArray utf8 = string.toUtf8();
+        appendNumber(&result, quint64(utf8.size()));
+        result.append(utf8);
+    }
+    result.append(tokens);
+    return result;
+}
+
+QByteArray EventStreamWriter::recorded(const QByteArray &document)
+{
+    QXmlStreamReader xml(document);
+    xml.setNamespaceProcessing(false);
+    EventStreamWriter writer;
+    while (!xml.atEnd()) {
+        xml.readNext();
+        writer.record(&xml);
+    }
+    return writer.data();
+}
@@ -0,0 +1,128 @@
+/*
+  SVGMin - Aggressive SVG minifier
+
+  Copyright (C) 2009 Ariya Hidayat (ariya.hidayat@gmail.com)
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#ifndef EVENTSTREAM_H
+#define EVENTSTREAM_H
+
+#include <QtCore/QByteArray>
+#include <QtCore/QHash>
+#include <QtCore/QString>
+#include <QtCore/QVector>
+#include <QtCore/QXmlStreamReader>
+
+// A tokenized document in a compact binary form, so that minifying it
+// again with other options skips the XML parser. The stream starts with
+// "SVGE" and a version byte, followed by the string table, which holds
+// every name, value and text once, and by the tokens, which refer to the
+// strings by number. Numbers are unsigned LEB128 varints and the character
+// offset of each token is stored as the distance from the one before.
+class EventStream
+{
+public:
+    static bool isEventStream(const QByteArray &data);
+
+    // false if the data is not an event stream of this version
+    bool load(const QByteArray &data);
+
+private:
+    friend class EventStreamReader;
+
+    QVector<QString> strings;
+    QByteArray tokens;
+};
+
+// Replays an event stream through the accessors of QXmlStreamReader which
+// the minifier uses. Comments, DTDs and entity references are not in the
+// stream.
+class EventStreamReader
+{
+public:
+    EventStreamReader(const EventStream *stream);
+
+    bool atEnd() const;
+    QXmlStreamReader::TokenType readNext();
+    QXmlStreamReader::TokenType tokenType() const { return type; }
+    bool hasError() const { return error; }
+    qint64 characterOffset() const { return offset; }
+
+    QStringRef documentVersion() const;
+    bool isStandaloneDocument() const { return standalone; }
+
+    QStringRef qualifiedName() const;
+    QStringRef prefix() const;
+    QStringRef name() const;
+    const QXmlStreamAttributes &attributes() const { return attributeList; }
+
+    QStringRef text() const;
+    bool isCDATA() const { return cdata; }
+    bool isWhitespace() const { return whitespace; }
+
+    QStringRef processingInstructionTarget() const;
+    QStringRef processingInstructionData() const;
+
+private:
+    quint64 readNumber();
+    const QString *readString();
+    QStringRef ref(QXmlStreamReader::TokenType expected, const QString *string) const;
+
+    const EventStream *stream;
+    int position;
+
+    QXmlStreamReader::TokenType type;
+    bool error;
+    qint64 offset;
+
+    // the name, target, text or version, and the data of an instruction
+    const QString *first;
+    const QString *second;
+    int colon;
+    bool standalone;
+    bool cdata;
+    bool whitespace;
+    QXmlStreamAttributes attributeList;
+};
+
+// Records the tokens of a reader as they are read, for data() to encode
+// them once the document is done.
+class EventStreamWriter
+{
+public:
+    EventStreamWriter();
+
+    void record(const QXmlStreamReader *xml);
+    QByteArray data() const;
+
+    // tokenizes the whole document
+    static QByteArray recorded(const QByteArray &document);
+
+private:
+    void appendString(const QStringRef &string);
+
+    QHash<QString, int> numbers;
+    QVector<QString> strings;
+    QByteArray tokens;
+    qint64 offset;
+};
+
+#endif
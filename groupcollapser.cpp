@@ -0,0 +1,358 @@
+/*
+  SVGMin - Aggressive SVG minifier
+
+  Copyright (C) 2009 Ariya Hidayat (ariya.hidayat@gmail.com)
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include "groupcollapser.h"
+
+#include <QtCore/QIODevice>
+#include <QtCore/QPair>
+#include <QtCore/QStack>
+#include <QtCore/QVector>
+#include <QtCore/QXmlStreamWriter>
+
+#include "svgproperties.h"
+#include "transform.h"
+
+// bounds the memory for a group held back, which for a group around the
+// whole drawing would otherwise grow with the document
+static const int maximumEvents = 256;
+static const int maximumSize = 64 * 1024;
+
+struct Event
+{
+    enum Type {
+        StartElement,
+        Attribute,
+        EndElement,
+        Characters,
+        CDATA,
+        ProcessingInstruction
+    };
+
+    Type type;
+    bool collapsible;
+    QString name;
+    QString value;
+};
+
+typedef QVector<QPair<QString, QString> > Attributes;
+
+class GroupCollapser::Private
+{
+public:
+    void append(Event::Type type, const QString &name, const QString &value,
+                bool collapsible = false);
+    void writeEvent(const Event &event);
+    void writeVerbatim();
+    void clear();
+    void writeContent(int first, int last);
+    void writeElement(int start, const Attributes &hoisted);
+    Attributes attributes(int start) const;
+    int contentStart(int start) const;
+    bool hoistable(const Attributes &attributes, int child) const;
+
+    QXmlStreamWriter *writer;
+
+    // the group held back, its events and for every start tag the index of
+    // the matching end tag
+    QVector<Event> events;
+    QVector<int> ends;
+    QStack<int> openElements;
+    int size;
+};
+
+GroupCollapser::GroupCollapser(QXmlStreamWriter *writer)
+{
+    d = new Private;
+    d->writer = writer;
+    d->size = 0;
+}
+
+GroupCollapser::~GroupCollapser()
+{
+    delete d;
+}
+
+void GroupCollapser::Private::append(Event::Type type, const QString &name, const QString &value,
+                                     bool collapsible)
+{
+    Event event;
+    event.type = type;
+    event.collapsible = collapsible;
+    event.name = name;
+    event.value = value;
+
+    if (type == Event::StartElement)
+        openElements.push(events.count());
+    ends.append(-1);
+    if (type == Event::EndElement)
+        ends[openElements.pop()] = events.count();
+    events.append(event);
+    size += name.size() + value.size();
+
+    if (openElements.isEmpty()) {
+        writeElement(0, Attributes());
+        clear();
+    } else if (events.count() > maximumEvents || size > maximumSize) {
+        // the end tags of the open elements follow without being held back
+        writeVerbatim();
+        clear();
+    }
+}
+
+void GroupCollapser::Private::writeEvent(const Event &event)
+{
+    switch (event.type) {
+    case Event::StartElement:
+        writer->writeStartElement(event.name);
+        break;
+    case Event::Attribute:
+        writer->writeAttribute(event.name, event.value);
+        break;
+    case Event::EndElement:
+        writer->writeEndElement();
+        break;
+    case Event::Characters:
+        writer->writeCharacters(event.value);
+        break;
+    case Event::CDATA:
+        writer->writeCDATA(event.value);
+        break;
+    case Event::ProcessingInstruction:
+        writer->writeProcessingInstruction(event.name, event.value);
+        break;
+    }
+}
+
+void GroupCollapser::Private::writeVerbatim()
+{
+    foreach (const Event &event, events)
+        writeEvent(event);
+}
+
+void GroupCollapser::Private::clear()
+{
+    events.clear();
+    ends.clear();
+    openElements.clear();
+    size = 0;
+}
+
+Attributes GroupCollapser::Private::attributes(int start) const
+{
+    Attributes result;
+    for (int i = start + 1; i < events.count() && events.at(i).type == Event::Attribute; ++i)
+        result.append(qMakePair(events.at(i).name, events.at(i).value));
+    return result;
+}
+
+int GroupCollapser::Private::contentStart(int start) const
+{
+    int i = start + 1;
+    while (events.at(i).type == Event::Attribute)
+        ++i;
+    return i;
+}
+
+void GroupCollapser::Private::writeContent(int first, int last)
+{
+    for (int i = first; i < last; ++i) {
+        if (events.at(i).type == Event::StartElement) {
+            writeElement(i, Attributes());
+            i = ends.at(i);
+        } else {
+            writeEvent(events.at(i));
+        }
+    }
+}
+
+// the transform and the inherited properties of a group apply in the same
+// way to its only child, unless another element uses the child
+bool GroupCollapser::Private::hoistable(const Attributes &attributes, int child) const
+{
+    if (!isTransformable(QStringRef(&events.at(child).name)))
+        return false;
+    for (int i = child + 1; events.at(i).type == Event::Attribute; ++i)
+        if (events.at(i).name == QLatin1String("id"))
+            return false;
+    for (int i = 0; i < attributes.count(); ++i) {
+        const QString &name = attributes.at(i).first;
+        if (name == QLatin1String("transform"))
+            continue;
+        const SvgProperty *property = findProperty(name);
+        if (!property || !(property->flags & SvgProperty::Inherited))
+            return false;
+    }
+    return true;
+}
+
+// writes an element with the attributes hoisted from a collapsed parent,
+// which go before its own transform and lose against its own properties
+void GroupCollapser::Private::writeElement(int start, const Attributes &hoisted)
+{
+    const Event &element = events.at(start);
+    Attributes merged = attributes(start);
+    for (int i = 0; i < hoisted.count(); ++i) {
+        const QString &name = hoisted.at(i).first;
+        int j = 0;
+        while (j < merged.count() && merged.at(j).first != name)
+            ++j;
+        if (j == merged.count())
+            merged.append(hoisted.at(i));
+        else if (name == QLatin1String("transform"))
+            merged[j].second = hoisted.at(i).second + QLatin1Char(' ') + merged.at(j).second;
+        else if (merged.at(j).second == QLatin1String("inherit"))
+            merged[j].second = hoisted.at(i).second;
+    }
+
+    const int first = contentStart(start);
+    const int last = ends.at(start);
+
+    if (element.collapsible) {
+        int children = 0;
+        int child = -1;
+        bool text = false;
+        for (int i = first; i < last; ++i) {
+            const Event &event = events.at(i);
+            if (event.type == Event::StartElement) {
+                ++children;
+                child = i;
+                i = ends.at(i);
+            } else if (event.type != Event::Characters || !event.value.trimmed().isEmpty()) {
+                text = true;
+            }
+        }
+
+        bool id = false;
+        for (int i = 0; i < merged.count(); ++i)
+            id = id || merged.at(i).first == QLatin1String("id");
+
+        // an empty group with an id could still be the target of a link
+        if (children == 0 && !text && !id)
+            return;
+        if (merged.isEmpty()) {
+            writeContent(first, last);
+            return;
+        }
+        if (children == 1 && !text && hoistable(merged, child)) {
+            writeElement(child, merged);
+            return;
+        }
+    }
+
+    writer->writeStartElement(element.name);
+    for (int i = 0; i < merged.count(); ++i)
+        writer->writeAttribute(merged.at(i).first, merged.at(i).second);
+    writeContent(first, last);
+    writer->writeEndElement();
+}
+
+void GroupCollapser::writeStartElement(const QString &name, bool collapsible)
+{
+    if (d->events.isEmpty() && !collapsible)
+        d->writer->writeStartElement(name);
+    else
+        d->append(Event::StartElement, name, QString(), collapsible);
+}
+
+void GroupCollapser::writeAttribute(const QString &name, const QString &value)
+{
+    if (d->events.isEmpty())
+        d->writer->writeAttribute(name, value);
+    else
+        d->append(Event::Attribute, name, value);
+}
+
+void GroupCollapser::writeEndElement()
+{
+    if (d->events.isEmpty())
+        d->writer->writeEndElement();
+    else
+        d->append(Event::EndElement, QString(), QString());
+}
+
+void GroupCollapser::writeCharacters(const QString &text)
+{
+    if (d->events.isEmpty())
+        d->writer->writeCharacters(text);
+    else
+        d->append(Event::Characters, QString(), text);
+}
+
+void GroupCollapser::writeCDATA(const QString &text)
+{
+    if (d->events.isEmpty())
+        d->writer->writeCDATA(text);
+    else
+        d->append(Event::CDATA, QString(), text);
+}
+
+void GroupCollapser::writeProcessingInstruction(const QString &target, const QString &data)
+{
+    if (d->events.isEmpty())
+        d->writer->writeProcessingInstruction(target, data);
+    else
+        d->append(Event::ProcessingInstruction, target, data);
+}
+
+void GroupCollapser::writeRawAttribute(const QString &name, const QStringRef &value)
+{
+    // held back with the element like any other attribute, the group may
+    // still collapse
+    QIODevice *device = d->writer->device();
+    if (!d->events.isEmpty() || !device) {
+        QString text = value.toString();
+        text.remove(QLatin1Char(' '));
+        writeAttribute(name, text);
+        return;
+    }
+
+    // QXmlStreamWriter passes every piece on to the device at once, so that
+    // the bytes written here end up inside the open start tag
+    device->write(" ");
+    device->write(name.toUtf8());
+    device->write("=\"");
+
+    static const int pieceSize = 64 * 1024;
+    QByteArray piece;
+    piece.reserve(pieceSize);
+    const QChar *unicode = value.unicode();
+    for (int i = 0; i < value.size(); ++i) {
+        const ushort c = unicode[i].unicode();
+        if (c == ' ')
+            continue;
+        piece += char(c);
+        if (piece.size() == pieceSize) {
+            device->write(piece);
+            piece.resize(0);
+        }
+    }
+    piece += '"';
+    device->write(piece);
+}
+
+void GroupCollapser::flush()
+{
+    d->writeVerbatim();
+    d->clear();
+}
@@ -0,0 +1,70 @@
+/*
+  SVGMin - Aggressive SVG minifier
+
+  Copyright (C) 2009 Ariya Hidayat (ariya.hidayat@gmail.com)
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#ifndef GROUPCOLLAPSER_H
+#define GROUPCOLLAPSER_H
+
+#include <QtCore/QString>
+
+class QXmlStreamWriter;
+
+// Writes the output document and removes redundant <g> elements on the
+// way. A group which may be collapsed is held back together with its
+// content until its end tag, or until that would exceed a few hundred
+// events, in which case it is written as it is. Then empty groups without
+// an id are dropped, groups without attributes are replaced by their
+// content and the transform and inherited properties of a group with a
+// single child move into that child.
+class GroupCollapser
+{
+public:
+    GroupCollapser(QXmlStreamWriter *writer);
+    ~GroupCollapser();
+
+    // collapsible is only for groups whose content does not depend on
+    // their structure, i.e. neither in a <switch> nor matched by a style
+    // sheet selector
+    void writeStartElement(const QString &name, bool collapsible = false);
+    void writeAttribute(const QString &name, const QString &value);
+    void writeEndElement();
+    void writeCharacters(const QString &text);
+    void writeCDATA(const QString &text);
+    void writeProcessingInstruction(const QString &target, const QString &data);
+
+    // Writes a long value, such as an embedded image, straight to the
+    // device in pieces, without copying or escaping it as a whole. The
+    // value must be ASCII without characters which need escaping; spaces
+    // are left out. Inside a group held back it is held back as well, as
+    // an ordinary attribute.
+    void writeRawAttribute(const QString &name, const QStringRef &value);
+
+    // writes the groups held back as they are
+    void flush();
+
+private:
+    class Private;
+    Private *d;
+};
+
+#endif
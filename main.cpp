@@ -25,11 +25,16 @@
 
 #include <QtCore/QCoreApplication>
 #include <QtCore/QFile>
+#include <QtCore/QList>
 #include <QtCore/QString>
+#include <QtCore/QStringList>
 
 #include <iostream>
 
+#include "options.h"
+#include "stdiobatch.h"
 #include "svgminifier.h"
+#include "tarminifier.h"
 
 void showHelp()
 {
@@ -46,12 +51,75 @@ void showHelp()
     std::cout <<  "--remove-editor-data [*]  Removes all Inkscape/Sodipodi/Adobe data" << std::endl;
     std::cout <<  "--keep-editor-data        Keeps all Inkscape/Sodipodi/Adobe data" << std::endl;
     std::cout <<  std::endl;
+    std::cout <<  "--collapse-whitespace=yes [*]" << std::endl;
+    std::cout <<  "                          Removes indentation and collapses whitespace" << std::endl;
+    std::cout <<  "                          in text, unless xml:space=\"preserve\"" << std::endl;
+    std::cout <<  "--collapse-whitespace=no  Keeps all whitespace and indents the output" << std::endl;
+    std::cout <<  std::endl;
+    std::cout <<  "--remove-defaults=yes [*] Removes attributes with the initial value or" << std::endl;
+    std::cout <<  "                          the value inherited anyway, the latter only" << std::endl;
+    std::cout <<  "                          with options which pre-scan the document" << std::endl;
+    std::cout <<  "--remove-defaults=no      Keeps such attributes" << std::endl;
+    std::cout <<  std::endl;
+    std::cout <<  "--style-to-class          Moves frequently repeated styles into classes" << std::endl;
+    std::cout <<  "--style-to-class=gzip     Same, but judged by the compressed size" << std::endl;
+    std::cout <<  std::endl;
+    std::cout <<  "--minify-css=yes [*]      Minifies the content of <style> elements" << std::endl;
+    std::cout <<  "--minify-css=no           Keeps <style> elements as they are" << std::endl;
+    std::cout <<  "--remove-unused-css       Removes style rules which match no class or id" << std::endl;
+    std::cout <<  std::endl;
+    std::cout <<  "--remove-unused-ns        Removes namespace declarations which no element" << std::endl;
+    std::cout <<  "                          or attribute uses once the rest is removed" << std::endl;
+    std::cout <<  std::endl;
+    std::cout <<  "--optimize-paths=yes [*]  Rewrites path data in its shortest form" << std::endl;
+    std::cout <<  "--optimize-paths=no       Keeps path data as it is" << std::endl;
+    std::cout <<  "--collapse-groups=yes [*] Removes empty groups and groups without" << std::endl;
+    std::cout <<  "                          attributes, moves the attributes of a group" << std::endl;
+    std::cout <<  "                          with a single child into the child" << std::endl;
+    std::cout <<  "--collapse-groups=no      Keeps all groups" << std::endl;
+    std::cout <<  "--convert-shapes          Writes rect, line, polyline and polygon as" << std::endl;
+    std::cout <<  "                          path where that is shorter" << std::endl;
+    std::cout <<  "--flatten-transforms      Moves transforms into single children and" << std::endl;
+    std::cout <<  "                          translations into coordinates" << std::endl;
+    std::cout <<  "--remove-hidden           Removes elements which are not displayed, fully" << std::endl;
+    std::cout <<  "                          transparent or of zero size" << std::endl;
+    std::cout <<  "--remove-unused-defs      Removes gradients, symbols, filters and other" << std::endl;
+    std::cout <<  "                          definitions which nothing in the document uses" << std::endl;
+    std::cout <<  "--merge-defs              Merges equal gradients, patterns, filters," << std::endl;
+    std::cout <<  "                          clip paths and masks and resolves gradients" << std::endl;
+    std::cout <<  "                          which only link to another one" << std::endl;
+    std::cout <<  "--reuse-subtrees          Replaces repeated elements with <use>" << std::endl;
+    std::cout <<  "                          elements which refer to the first one" << std::endl;
+    std::cout <<  "--recompress-images       Deflates embedded PNG images again at the" << std::endl;
+    std::cout <<  "                          highest level without ancillary chunks" << std::endl;
+    std::cout <<  "--precision=N             Rounds coordinates, lengths and other numbers" << std::endl;
+    std::cout <<  "                          to N decimals, the default keeps them exact" << std::endl;
+    std::cout <<  std::endl;
+    std::cout <<  "--optimize=size           Also tries the other combinations of the style" << std::endl;
+    std::cout <<  "                          options and keeps the smallest output" << std::endl;
+    std::cout <<  "--optimize=gzip           Same, but judged by the compressed size" << std::endl;
+    std::cout <<  "--time-budget=MS          Time per document for the other combinations" << std::endl;
+    std::cout <<  "                          of --optimize, 1000 by default" << std::endl;
+    std::cout <<  std::endl;
     std::cout <<  "--remove-id=foo           Removes all ids which start with 'foo'" << std::endl;
     std::cout <<  "--keep-id=foo             Keeps all ids which start with 'foo'" << std::endl;
     std::cout <<  std::endl;
     std::cout <<  "The default is to remove the following ids:" << std::endl;
     std::cout <<  "g, circle, path, polygon, polyline, rect, text" << std::endl;
     std::cout <<  "To override any of these, use the --keep-id option." << std::endl;
+    std::cout <<  std::endl;
+    std::cout <<  "--variant=FILE            Also writes FILE from the same parse, with the" << std::endl;
+    std::cout <<  "                          options given so far and those which follow" << std::endl;
+    std::cout <<  "                          up to the next --variant" << std::endl;
+    std::cout <<  std::endl;
+    std::cout <<  "--save-events=FILE        Records the parsed input to FILE, which can be" << std::endl;
+    std::cout <<  "                          minified again in place of the input without" << std::endl;
+    std::cout <<  "                          parsing the XML, e.g. with other options" << std::endl;
+    std::cout <<  std::endl;
+    std::cout <<  "--tar                     Reads a tar archive and minifies every" << std::endl;
+    std::cout <<  "                          .svg/.svgz member, other members are copied" << std::endl;
+    std::cout <<  "--stdio-batch             Serves length-prefixed minify requests on" << std::endl;
+    std::cout <<  "                          standard input, see stdiobatch.h" << std::endl;
     std::cout << std::endl;
 }
 
@@ -63,40 +131,37 @@ int main(int argc, char **argv)
     QString outputFile;
 
     SvgMinifier minifier;
+    bool tarArchive = false;
+    bool stdioBatch = false;
+
+    // the options after a --variant apply to that variant only
+    QList<SvgMinifier> variants;
+    QStringList variantFiles;
+    SvgMinifier *configured = &minifier;
+
+    QString eventFile;
 
     for (int i = 1; i < argc; ++i) {
         QString arg = QString::fromLocal8Bit(argv[i]);
         if (arg[0] == '-') {
-            arg.remove(0, 1);
-            if (arg == "h" || arg == "-help") {
+            if (arg == "-h" || arg == "--help") {
                 showHelp();
                 return 0;
             }
 
-            if (arg == "-style-to-xml=yes")
-                minifier.setConvertStyle(true);
-            if (arg == "-style-to-xml=no")
-                minifier.setConvertStyle(false);
-
-            if (arg == "-simplify-style=yes")
-                minifier.setSimplifyStyle(true);
-            if (arg == "-simplify-style=no")
-                minifier.setSimplifyStyle(false);
-
-            if (arg == "-keep-metadata")
-                minifier.setKeepMetadata(true);
-            if (arg == "-remove-metadata")
-                minifier.setKeepMetadata(false);
-
-            if (arg == "-keep-editor-data")
-                minifier.setKeepEditorData(true);
-            if (arg == "-remove-editor-data")
-                minifier.setKeepEditorData(false);
-
-            if (arg.startsWith("-remove-id="))
-                minifier.removeId(arg.mid(11)); // "-remove-id="
-            if (arg.startsWith("-keep-id="))
-                minifier.keepId(arg.mid(9)); // "-keep-id="
+            if (arg == "--tar") {
+                tarArchive = true;
+            } else if (arg == "--stdio-batch") {
+                stdioBatch = true;
+            } else if (arg.startsWith("--save-events=")) {
+                eventFile = arg.mid(14).trimmed();
+            } else if (arg.startsWith("--variant=")) {
+                variants += *configured;
+                variantFiles += arg.mid(10);
+                configured = &variants.last();
+            } else {
+                applyOption(configured, arg);
+            }
 
         } else {
             if (inputFile.isEmpty())
@@ -106,6 +171,11 @@ int main(int argc, char **argv)
         }
     }
 
+    if (stdioBatch) {
+        StdioBatch batch(minifier);
+        return batch.run() ? 0 : 1;
+    }
+
     inputFile = inputFile.trimmed();
     outputFile = outputFile.trimmed();
 
@@ -124,7 +194,36 @@ int main(int argc, char **argv)
         minifier.setOutputDevice(&outputDevice);
     }
 
-    minifier.run();
+    // variants are written for single documents only
+    QList<QFile *> variantDevices;
+    for (int i = 0; !tarArchive && i < variants.count(); ++i) {
+        QFile *device = new QFile(variantFiles.at(i).trimmed());
+        variantDevices += device;
+        if (!device->open(QFile::WriteOnly))
+            continue;
+        variants[i].setOutputDevice(device);
+        minifier.addVariant(variants.at(i));
+    }
+
+    // the events are recorded for single documents only
+    QFile eventDevice;
+    if (!eventFile.isEmpty() && !tarArchive) {
+        eventDevice.setFileName(eventFile);
+        if (eventDevice.open(QFile::WriteOnly))
+            minifier.setEventStreamDevice(&eventDevice);
+    }
+
+    bool ok;
+    if (tarArchive) {
+        TarMinifier tar(minifier);
+        if (inputDevice.isOpen())
+            tar.setInputDevice(&inputDevice);
+        if (outputDevice.isOpen())
+            tar.setOutputDevice(&outputDevice);
+        ok = tar.run();
+    } else {
+        ok = minifier.run();
+    }
 
     if (inputDevice.isOpen())
         inputDevice.close();
@@ -132,6 +231,13 @@ int main(int argc, char **argv)
     if (outputDevice.isOpen())
         outputDevice.close();
 
-    return 0;
+    if (eventDevice.isOpen())
+        eventDevice.close();
+
+    foreach (QFile *device, variantDevices)
+        device->close();
+    qDeleteAll(variantDevices);
+
+    return ok ? 0 : 1;
 }
 
@@ -0,0 +1,363 @@
+/*
+  SVGMin - Aggressive SVG minifier
+
+  Copyright (C) 2009 Ariya Hidayat (ariya.hidayat@gmail.com)
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include "numberformat.h"
+
+#include <QtCore/QByteArray>
+
+#include <math.h>
+#include <string.h>
+
+// powers of ten which are exact doubles
+static const double powersOfTen[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static const int maxExactPower = 22;
+
+// 2^53, any integer up to this is an exact double
+static const quint64 maxExactInteger = Q_UINT64_C(9007199254740992);
+
+static inline bool isDigit(QChar c)
+{
+    return c.unicode() >= '0' && c.unicode() <= '9';
+}
+
+bool parseNumber(const QChar *&pos, const QChar *end, double *value)
+{
+    const QChar *p = pos;
+
+    bool negative = false;
+    if (p < end && (p->unicode() == '+' || p->unicode() == '-')) {
+        negative = p->unicode() == '-';
+        ++p;
+    }
+
+    quint64 mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    bool hasDigits = false;
+    bool truncated = false;
+
+    for (; p < end && isDigit(*p); ++p) {
+        hasDigits = true;
+        if (digits < 19) {
+            mantissa = mantissa * 10 + (p->unicode() - '0');
+            if (mantissa)
+                ++digits;
+        } else {
+            ++exponent;
+            truncated = truncated || p->unicode() != '0';
+        }
+    }
+
+    if (p < end && p->unicode() == '.') {
+        ++p;
+        for (; p < end && isDigit(*p); ++p) {
+            hasDigits = true;
+            if (digits < 19) {
+                mantissa = mantissa * 10 + (p->unicode() - '0');
+                if (mantissa)
+                    ++digits;
+                --exponent;
+            } else {
+                truncated = truncated || p->unicode() != '0';
+            }
+        }
+    }
+
+    if (!hasDigits)
+        return false;
+
+    // only an exponent if digits follow, think of "10em"
+    if (p < end && (p->unicode() == 'e' || p->unicode() == 'E')) {
+        const QChar *q = p + 1;
+        bool negativeExponent = false;
+        if (q < end && (q->unicode() == '+' || q->unicode() == '-')) {
+            negativeExponent = q->unicode() == '-';
+            ++q;
+        }
+        if (q < end && isDigit(*q)) {
+            int e = 0;
+            for (; q < end && isDigit(*q); ++q)
+                if (e < 100000)
+                    e = e * 10 + (q->unicode() - '0');
+            exponent += negativeExponent ? -e : e;
+            p = q;
+        }
+    }
+
+    double result;
+    if (!truncated && mantissa <= maxExactInteger
+        && exponent >= -maxExactPower && exponent <= maxExactPower) {
+        // both operands are exact, so the result is correctly rounded
+        result = double(mantissa);
+        if (exponent < 0)
+            result /= powersOfTen[-exponent];
+        else
+            result *= powersOfTen[exponent];
+        if (negative)
+            result = -result;
+    } else {
+        QByteArray text;
+        text.reserve(int(p - pos));
+        for (const QChar *c = pos; c < p; ++c)
+            text += char(c->unicode());
+        bool ok;
+        result = text.toDouble(&ok);
+        if (!ok)
+            return false;
+    }
+
+    *value = result;
+    pos = p;
+    return true;
+}
+
+bool parseNumber(const QStringRef &text, double *value)
+{
+    const QChar *pos = text.unicode();
+    const QChar *end = pos + text.size();
+    while (pos < end && (pos->unicode() == ' ' || pos->unicode() == '\t'
+                         || pos->unicode() == '\n' || pos->unicode() == '\r'))
+        ++pos;
+    while (end > pos && (end[-1].unicode() == ' ' || end[-1].unicode() == '\t'
+                         || end[-1].unicode() == '\n' || end[-1].unicode() == '\r'))
+        --end;
+    return parseNumber(pos, end, value) && pos == end;
+}
+
+// Writes value = digits * 10^exponent, choosing between the plain notation
+// and the exponent notation. digits must not have trailing zeros.
+static int composeNumber(bool negative, const char *digits, int count, int exponent, char *buffer)
+{
+    int length = 0;
+    if (negative)
+        buffer[length++] = '-';
+
+    // plain notation length
+    int plain;
+    if (exponent >= 0)
+        plain = count + exponent;
+    else if (count > -exponent)
+        plain = count + 1;
+    else
+        plain = 1 - exponent;
+
+    // exponent notation with an integer mantissa, e.g. "15e-7"
+    char exponentText[8];
+    int exponentLength = 0;
+    {
+        int e = exponent < 0 ? -exponent : exponent;
+        char reversed[8];
+        int n = 0;
+        do {
+            reversed[n++] = char('0' + e % 10);
+            e /= 10;
+        } while (e);
+        if (exponent < 0)
+            exponentText[exponentLength++] = '-';
+        while (n)
+            exponentText[exponentLength++] = reversed[--n];
+    }
+
+    if (exponent != 0 && count + 1 + exponentLength < plain) {
+        memcpy(buffer + length, digits, count);
+        length += count;
+        buffer[length++] = 'e';
+        memcpy(buffer + length, exponentText, exponentLength);
+        length += exponentLength;
+    } else if (exponent >= 0) {
+        memcpy(buffer + length, digits, count);
+        length += count;
+        for (int i = 0; i < exponent; ++i)
+            buffer[length++] = '0';
+    } else if (count > -exponent) {
+        const int integral = count + exponent;
+        memcpy(buffer + length, digits, integral);
+        length += integral;
+        buffer[length++] = '.';
+        memcpy(buffer + length, digits + integral, count - integral);
+        length += count - integral;
+    } else {
+        buffer[length++] = '.';
+        for (int i = 0; i < -exponent - count; ++i)
+            buffer[length++] = '0';
+        memcpy(buffer + length, digits, count);
+        length += count;
+    }
+
+    buffer[length] = '\0';
+    return length;
+}
+
+// writes the decimal digits of value without trailing zeros,
+// which are accounted for in the exponent instead
+static int integerDigits(quint64 value, char *digits, int *exponent)
+{
+    while (value && value % 10 == 0) {
+        value /= 10;
+        ++*exponent;
+    }
+    char reversed[24];
+    int count = 0;
+    do {
+        reversed[count++] = char('0' + value % 10);
+        value /= 10;
+    } while (value);
+    for (int i = 0; i < count; ++i)
+        digits[i] = reversed[count - 1 - i];
+    return count;
+}
+
+static bool exactValue(quint64 mantissa, int exponent, double *value)
+{
+    if (mantissa > maxExactInteger || exponent < -maxExactPower || exponent > maxExactPower)
+        return false;
+    *value = exponent < 0 ? double(mantissa) / powersOfTen[-exponent]
+                          : double(mantissa) * powersOfTen[exponent];
+    return true;
+}
+
+// slow path for values which need more than 15 significant digits
+static int formatExact(double value, char *buffer)
+{
+    const QByteArray text = QByteArray::number(value, 'g', 17);
+    const QByteArray shorter = QByteArray::number(value, 'g', 16);
+    const QByteArray &chosen = shorter.toDouble() == value ? shorter : text;
+
+    char digits[24];
+    int count = 0;
+    int exponent = 0;
+    bool negative = false;
+    bool fraction = false;
+    for (int i = 0; i < chosen.size(); ++i) {
+        const char c = chosen.at(i);
+        if (c == '-') {
+            negative = true;
+        } else if (c == '.') {
+            fraction = true;
+        } else if (c >= '0' && c <= '9') {
+            if (count == 0 && c == '0') {
+                if (fraction)
+                    --exponent;
+                continue;
+            }
+            if (count < 20)
+                digits[count++] = c;
+            if (fraction)
+                --exponent;
+        } else if (c == 'e' || c == 'E') {
+            exponent += chosen.mid(i + 1).toInt();
+            break;
+        }
+    }
+    while (count > 1 && digits[count - 1] == '0') {
+        --count;
+        ++exponent;
+    }
+    if (count == 0) {
+        buffer[0] = '0';
+        buffer[1] = '\0';
+        return 1;
+    }
+    return composeNumber(negative, digits, count, exponent, buffer);
+}
+
+double roundNumber(double value, int precision)
+{
+    if (precision < 0 || precision > maxExactPower)
+        return value;
+    const double scaled = value * powersOfTen[precision];
+    if (fabs(scaled) >= double(maxExactInteger))
+        return value;
+    return double(qint64(scaled < 0 ? scaled - 0.5 : scaled + 0.5)) / powersOfTen[precision];
+}
+
+int formatNumber(double value, int precision, char *buffer)
+{
+    if (value != value || value - value != 0) {
+        // NaN or infinity, neither is valid in SVG
+        buffer[0] = '0';
+        buffer[1] = '\0';
+        return 1;
+    }
+
+    const bool negative = value < 0;
+    const double magnitude = negative ? -value : value;
+
+    char digits[24];
+    int exponent;
+
+    if (precision >= 0 && precision <= maxExactPower) {
+        const double scaled = magnitude * powersOfTen[precision];
+        if (scaled < double(maxExactInteger)) {
+            const quint64 rounded = quint64(scaled + 0.5);
+            if (rounded == 0) {
+                buffer[0] = '0';
+                buffer[1] = '\0';
+                return 1;
+            }
+            exponent = -precision;
+            const int count = integerDigits(rounded, digits, &exponent);
+            return composeNumber(negative, digits, count, exponent, buffer);
+        }
+    }
+
+    if (magnitude == 0) {
+        buffer[0] = '0';
+        buffer[1] = '\0';
+        return 1;
+    }
+
+    // try 15 significant digits, which is enough for most values
+    exponent = int(floor(log10(magnitude))) - 14;
+    if (exponent >= -maxExactPower && exponent <= maxExactPower) {
+        const double scaled = exponent < 0 ? magnitude * powersOfTen[-exponent]
+                                           : magnitude / powersOfTen[exponent];
+        quint64 mantissa = quint64(scaled + 0.5);
+        double check;
+        if (exactValue(mantissa, exponent, &check) && check == magnitude) {
+            const int count = integerDigits(mantissa, digits, &exponent);
+            return composeNumber(negative, digits, count, exponent, buffer);
+        }
+    }
+
+    return formatExact(value, buffer);
+}
+
+void appendNumbers(QString *string, const double *values, int count, int precision)
+{
+    bool afterDecimalPoint = false;
+    for (int i = 0; i < count; ++i) {
+        char text[NumberBufferSize];
+        const int length = formatNumber(values[i], precision, text);
+        if (i > 0 && text[0] != '-' && !(text[0] == '.' && afterDecimalPoint))
+            string->append(QLatin1Char(' '));
+        for (int j = 0; j < length; ++j)
+            string->append(QLatin1Char(text[j]));
+        afterDecimalPoint = memchr(text, '.', length) && !memchr(text, 'e', length);
+    }
+}
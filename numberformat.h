@@ -0,0 +1,65 @@
+/*
+  SVGMin - Aggressive SVG minifier
+
+  Copyright (C) 2009 Ariya Hidayat (ariya.hidayat@gmail.com)
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#ifndef NUMBERFORMAT_H
+#define NUMBERFORMAT_H
+
+#include <QtCore/QString>
+
+// large enough for any number written by formatNumber()
+enum { NumberBufferSize = 32 };
+
+// Parses a number in SVG syntax (sign, digits, fraction and exponent)
+// starting at pos, which is moved behind it on success. Short numbers are
+// converted without any allocation.
+bool parseNumber(const QChar *&pos, const QChar *end, double *value);
+
+// Parses a value which is a plain number without unit, apart from
+// surrounding whitespace.
+bool parseNumber(const QStringRef &text, double *value);
+
+// Writes the shortest text representing the value rounded to the given
+// number of decimals into buffer and returns its length. A negative
+// precision keeps the value exactly, i.e. the text converts back to the
+// same double. Leading zeros are omitted (".5") and an exponent is used
+// when that is shorter ("1e6").
+int formatNumber(double value, int precision, char *buffer);
+
+// the value as formatNumber() would write it
+double roundNumber(double value, int precision);
+
+inline void appendNumber(QString *string, double value, int precision)
+{
+    char buffer[NumberBufferSize];
+    const int length = formatNumber(value, precision, buffer);
+    for (int i = 0; i < length; ++i)
+        string->append(QLatin1Char(buffer[i]));
+}
+
+// Appends the values separated as in path data and transform lists, i.e.
+// without a space before a minus sign or where a second decimal point
+// starts the next number ("1-2", ".5.5").
+void appendNumbers(QString *string, const double *values, int count, int precision);
+
+#endif
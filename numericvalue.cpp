@@ -0,0 +1,200 @@
+/*
+  SVGMin - Aggressive SVG minifier
+
+  Copyright (C) 2009 Ariya Hidayat (ariya.hidayat@gmail.com)
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include "numericvalue.h"
+
+#include "numberformat.h"
+#include "svgproperties.h"
+#include "transform.h"
+
+static inline bool isSpace(ushort c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f';
+}
+
+static inline bool isLetter(ushort c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+static void skipSeparators(const QChar *&pos, const QChar *end, bool *comma = 0)
+{
+    while (pos < end && isSpace(pos->unicode()))
+        ++pos;
+    if (pos < end && pos->unicode() == ',') {
+        ++pos;
+        if (comma)
+            *comma = true;
+        while (pos < end && isSpace(pos->unicode()))
+            ++pos;
+    }
+}
+
+// a number with an optional unit, "12", "1.5px" or "50%"
+static bool appendLength(const QChar *&pos, const QChar *end, int precision, QString *buffer)
+{
+    double value;
+    if (!parseNumber(pos, end, &value))
+        return false;
+    appendNumber(buffer, value, precision);
+    if (pos < end && pos->unicode() == '%') {
+        buffer->append(*pos++);
+    } else {
+        while (pos < end && isLetter(pos->unicode()))
+            buffer->append(*pos++);
+    }
+    return true;
+}
+
+static bool appendNumberList(const QChar *pos, const QChar *end, int precision, QString *buffer)
+{
+    skipSeparators(pos, end);
+    if (pos == end)
+        return false;
+    // a single space between the items is valid everywhere, unlike in path
+    // data some list grammars need a separator even before a minus sign
+    while (pos < end) {
+        if (!appendLength(pos, end, precision, buffer))
+            return false;
+        bool comma = false;
+        skipSeparators(pos, end, &comma);
+        if (pos < end)
+            buffer->append(QLatin1Char(' '));
+        else if (comma)
+            return false;
+    }
+    return true;
+}
+
+// plain numbers, separated only where needed
+static bool appendCoordinateList(const QChar *pos, const QChar *end, int precision, QString *buffer)
+{
+    double values[64];
+    bool first = true;
+    skipSeparators(pos, end);
+    while (pos < end) {
+        int count = 0;
+        while (pos < end && count < 64) {
+            if (!parseNumber(pos, end, &values[count++]))
+                return false;
+            skipSeparators(pos, end);
+        }
+        // the next chunk continues after a number as well
+        if (!first && roundNumber(values[0], precision) >= 0)
+            buffer->append(QLatin1Char(' '));
+        appendNumbers(buffer, values, count, precision);
+        first = false;
+    }
+    return !first;
+}
+
+// "name(number[,number]*)", separated by whitespace, keeping the functions
+static bool appendTransformList(const QChar *pos, const QChar *end, int precision, QString *buffer)
+{
+    skipSeparators(pos, end);
+    if (pos == end)
+        return false;
+    while (pos < end) {
+        const QChar *name = pos;
+        while (pos < end && isLetter(pos->unicode()))
+            ++pos;
+        if (pos == name)
+            return false;
+        const QString function(name, int(pos - name));
+        buffer->append(function);
+        while (pos < end && isSpace(pos->unicode()))
+            ++pos;
+        if (pos == end || pos->unicode() != '(')
+            return false;
+        ++pos;
+        buffer->append(QLatin1Char('('));
+
+        // matrix() has the most arguments
+        double args[6];
+        int count = 0;
+        for (;;) {
+            skipSeparators(pos, end);
+            if (pos < end && pos->unicode() == ')')
+                break;
+            if (count == 6 || !parseNumber(pos, end, &args[count]))
+                return false;
+            ++count;
+        }
+        ++pos;
+        // only coordinates are rounded, i.e. the translation and the center
+        // of a rotation, the error of a scale or an angle grows with the
+        // distance from the origin
+        int first = count;
+        if (function == QLatin1String("translate"))
+            first = 0;
+        else if (function == QLatin1String("matrix"))
+            first = 4;
+        else if (function == QLatin1String("rotate"))
+            first = 1;
+        for (int i = first; i < count; ++i)
+            args[i] = roundNumber(args[i], precision);
+        appendNumbers(buffer, args, count, -1);
+        buffer->append(QLatin1Char(')'));
+
+        skipSeparators(pos, end);
+        if (pos < end)
+            buffer->append(QLatin1Char(' '));
+    }
+    return true;
+}
+
+bool shortenNumericValue(const QStringRef &value, int type, int precision, QString *buffer)
+{
+    const QChar *pos = value.unicode();
+    const QChar *end = pos + value.size();
+    const int size = buffer->size();
+
+    bool ok = false;
+    if (type & SvgProperty::Number) {
+        while (pos < end && isSpace(pos->unicode()))
+            ++pos;
+        while (end > pos && isSpace(end[-1].unicode()))
+            --end;
+        ok = appendLength(pos, end, precision, buffer) && pos == end;
+    } else if (type & SvgProperty::NumberList) {
+        ok = appendNumberList(pos, end, precision, buffer);
+    } else if (type & SvgProperty::CoordinateList) {
+        ok = appendCoordinateList(pos, end, precision, buffer);
+    } else if (type & SvgProperty::TransformList) {
+        ok = appendTransformList(pos, end, precision, buffer);
+        // the product may be shorter, e.g. for matrix(1,0,0,1,10,0)
+        Transform transform;
+        if (ok && parseTransform(value, &transform)) {
+            const QString text = transformText(transform, precision);
+            if (text.size() < buffer->size() - size) {
+                buffer->truncate(size);
+                buffer->append(text);
+            }
+        }
+    }
+
+    if (!ok)
+        buffer->truncate(size);
+    return ok;
+}
@@ -0,0 +1,40 @@
+/*
+  SVGMin - Aggressive SVG minifier
+
+  Copyright (C) 2009 Ariya Hidayat (ariya.hidayat@gmail.com)
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#ifndef NUMERICVALUE_H
+#define NUMERICVALUE_H
+
+#include <QtCore/QString>
+
+// Rewrites the numbers in an attribute or property value of the given type
+// (one of the value type flags of SvgProperty) through formatNumber(), with
+// the given precision. Units are kept as they are, a transform list becomes
+// its shortest equivalent, which is empty for the identity. Only the
+// coordinates in a transform list are rounded, its scale, angle and skew
+// values are kept exactly.
+// The result is appended to the buffer, which is left unchanged if the value
+// does not have the expected form, e.g. "auto" or "inherit".
+bool shortenNumericValue(const QStringRef &value, int type, int precision, QString *buffer);
+
+#endif
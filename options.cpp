@@ -0,0 +1,193 @@
+/*
+  SVGMin - Aggressive SVG minifier
+
+  Copyright (C) 2009 Ariya Hidayat (ariya.hidayat@gmail.com)
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include "options.h"
+
+#include "svgminifier.h"
+
+bool applyOption(SvgMinifier *minifier, const QString &arg)
+{
+    if (arg == "--style-to-xml=yes") {
+        minifier->setConvertStyle(true);
+        return true;
+    }
+    if (arg == "--style-to-xml=no") {
+        minifier->setConvertStyle(false);
+        return true;
+    }
+
+    if (arg == "--simplify-style=yes") {
+        minifier->setSimplifyStyle(true);
+        return true;
+    }
+    if (arg == "--simplify-style=no") {
+        minifier->setSimplifyStyle(false);
+        return true;
+    }
+
+    if (arg == "--keep-metadata") {
+        minifier->setKeepMetadata(true);
+        return true;
+    }
+    if (arg == "--remove-metadata") {
+        minifier->setKeepMetadata(false);
+        return true;
+    }
+
+    if (arg == "--keep-editor-data") {
+        minifier->setKeepEditorData(true);
+        return true;
+    }
+    if (arg == "--remove-editor-data") {
+        minifier->setKeepEditorData(false);
+        return true;
+    }
+
+    if (arg == "--minify-css=yes") {
+        minifier->setMinifyStyleSheets(true);
+        return true;
+    }
+    if (arg == "--minify-css=no") {
+        minifier->setMinifyStyleSheets(false);
+        return true;
+    }
+    if (arg == "--remove-unused-css") {
+        minifier->setRemoveUnusedStyleRules(true);
+        return true;
+    }
+
+    if (arg == "--style-to-class") {
+        minifier->setStyleToClass(true);
+        return true;
+    }
+    if (arg == "--style-to-class=gzip") {
+        minifier->setStyleToClass(true);
+        minifier->setGzipCostModel(true);
+        return true;
+    }
+
+    if (arg == "--optimize-paths=yes") {
+        minifier->setOptimizePaths(true);
+        return true;
+    }
+    if (arg == "--optimize-paths=no") {
+        minifier->setOptimizePaths(false);
+        return true;
+    }
+    if (arg == "--remove-defaults=yes") {
+        minifier->setRemoveDefaults(true);
+        return true;
+    }
+    if (arg == "--remove-defaults=no") {
+        minifier->setRemoveDefaults(false);
+        return true;
+    }
+
+    if (arg == "--collapse-whitespace=yes") {
+        minifier->setCollapseWhitespace(true);
+        return true;
+    }
+    if (arg == "--collapse-whitespace=no") {
+        minifier->setCollapseWhitespace(false);
+        return true;
+    }
+
+    if (arg == "--collapse-groups=yes") {
+        minifier->setCollapseGroups(true);
+        return true;
+    }
+    if (arg == "--collapse-groups=no") {
+        minifier->setCollapseGroups(false);
+        return true;
+    }
+
+    if (arg == "--convert-shapes") {
+        minifier->setConvertShapes(true);
+        return true;
+    }
+    if (arg == "--remove-unused-ns") {
+        minifier->setRemoveUnusedNamespaces(true);
+        return true;
+    }
+    if (arg == "--recompress-images") {
+        minifier->setRecompressImages(true);
+        return true;
+    }
+    if (arg == "--remove-hidden") {
+        minifier->setRemoveHidden(true);
+        return true;
+    }
+    if (arg == "--remove-unused-defs") {
+        minifier->setRemoveUnusedDefinitions(true);
+        return true;
+    }
+    if (arg == "--merge-defs") {
+        minifier->setMergeDefinitions(true);
+        return true;
+    }
+    if (arg == "--reuse-subtrees") {
+        minifier->setReuseSubtrees(true);
+        return true;
+    }
+    if (arg == "--flatten-transforms") {
+        minifier->setFlattenTransforms(true);
+        return true;
+    }
+    if (arg.startsWith("--precision=")) {
+        bool ok;
+        const int decimals = arg.mid(12).toInt(&ok); // "--precision="
+        if (!ok || decimals < 0)
+            return false;
+        minifier->setPrecision(decimals);
+        return true;
+    }
+
+    if (arg == "--optimize=size") {
+        minifier->setAutoTune(SvgMinifier::TuneSize);
+        return true;
+    }
+    if (arg == "--optimize=gzip") {
+        minifier->setAutoTune(SvgMinifier::TuneCompressedSize);
+        return true;
+    }
+    if (arg.startsWith("--time-budget=")) {
+        bool ok;
+        const int milliseconds = arg.mid(14).toInt(&ok); // "--time-budget="
+        if (!ok || milliseconds < 0)
+            return false;
+        minifier->setTimeBudget(milliseconds);
+        return true;
+    }
+
+    if (arg.startsWith("--remove-id=")) {
+        minifier->removeId(arg.mid(12)); // "--remove-id="
+        return true;
+    }
+    if (arg.startsWith("--keep-id=")) {
+        minifier->keepId(arg.mid(10)); // "--keep-id="
+        return true;
+    }
+
+    return false;
+}
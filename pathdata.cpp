@@ -0,0 +1,351 @@
+/*
+  SVGMin - Aggressive SVG minifier
+
+  Copyright (C) 2009 Ariya Hidayat (ariya.hidayat@gmail.com)
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include "pathdata.h"
+
+#include <string.h>
+
+#include "numberformat.h"
+
+// enough for the seven arguments of an arc
+enum { SegmentBufferSize = 8 * (NumberBufferSize + 1) };
+
+struct PathWriter
+{
+    PathWriter() : implicitCommand(0), afterNumber(false), afterDecimalPoint(false) {}
+
+    // the command a number without letter continues, "L" after "M"
+    char implicitCommand;
+    bool afterNumber;
+    bool afterDecimalPoint;
+};
+
+static inline bool isSeparator(ushort c)
+{
+    return c == ' ' || c == ',' || c == '\t' || c == '\n' || c == '\r' || c == '\f';
+}
+
+static inline bool isCommand(ushort c)
+{
+    switch (c) {
+    case 'M': case 'm': case 'Z': case 'z': case 'L': case 'l':
+    case 'H': case 'h': case 'V': case 'v': case 'C': case 'c':
+    case 'S': case 's': case 'Q': case 'q': case 'T': case 't':
+    case 'A': case 'a':
+        return true;
+    default:
+        return false;
+    }
+}
+
+static int argumentCount(ushort command)
+{
+    switch (command | 0x20) {
+    case 'm': case 'l': case 't':
+        return 2;
+    case 'h': case 'v':
+        return 1;
+    case 'c':
+        return 6;
+    case 's': case 'q':
+        return 4;
+    case 'a':
+        return 7;
+    default:
+        return 0;
+    }
+}
+
+static void skipSeparators(const QChar *&pos, const QChar *end)
+{
+    while (pos < end && isSeparator(pos->unicode()))
+        ++pos;
+}
+
+static bool parseFlag(const QChar *&pos, const QChar *end, double *value)
+{
+    if (pos < end && (pos->unicode() == '0' || pos->unicode() == '1')) {
+        *value = pos->unicode() - '0';
+        ++pos;
+        return true;
+    }
+    return false;
+}
+
+// Formats one segment into buffer as the writer would continue with it and
+// returns its length. Arguments with their bit set in flagMask are arc flags.
+static int formatSegment(const PathWriter &writer, char command, const double *values,
+                         int count, int flagMask, int precision, char *buffer,
+                         PathWriter *state)
+{
+    PathWriter s = writer;
+    int length = 0;
+
+    if (command != s.implicitCommand || count == 0) {
+        buffer[length++] = command;
+        s.afterNumber = false;
+    }
+
+    for (int i = 0; i < count; ++i) {
+        if (flagMask & (1 << i)) {
+            // a flag is a single digit, so nothing can stick to it
+            if (s.afterNumber)
+                buffer[length++] = ' ';
+            buffer[length++] = values[i] ? '1' : '0';
+            s.afterNumber = false;
+            continue;
+        }
+
+        char text[NumberBufferSize];
+        const int n = formatNumber(values[i], precision, text);
+        if (s.afterNumber && text[0] != '-' && !(text[0] == '.' && s.afterDecimalPoint))
+            buffer[length++] = ' ';
+        memcpy(buffer + length, text, n);
+        length += n;
+        s.afterNumber = true;
+        s.afterDecimalPoint = memchr(text, '.', n) && !memchr(text, 'e', n);
+    }
+
+    switch (command) {
+    case 'M':
+        s.implicitCommand = 'L';
+        break;
+    case 'm':
+        s.implicitCommand = 'l';
+        break;
+    case 'Z':
+    case 'z':
+        s.implicitCommand = 0;
+        break;
+    default:
+        s.implicitCommand = command;
+        break;
+    }
+
+    *state = s;
+    return length;
+}
+
+static void append(QString *result, const char *text, int length)
+{
+    for (int i = 0; i < length; ++i)
+        result->append(QLatin1Char(text[i]));
+}
+
+static bool optimize(const QStringRef &data, int precision, double dx, double dy, QString *out)
+{
+    const QChar *pos = data.unicode();
+    const QChar *end = pos + data.size();
+
+    QString &result = *out;
+    result.reserve(data.size());
+    PathWriter writer;
+
+    // current point and subpath start, as given in the input but moved
+    double x = dx, y = dy;
+    double startX = dx, startY = dy;
+
+    // the same as the output has them, i.e. rounded
+    double outX = 0, outY = 0;
+    double outStartX = 0, outStartY = 0;
+
+    ushort command = 0;
+    bool first = true;
+
+    for (;;) {
+        skipSeparators(pos, end);
+        if (pos == end)
+            break;
+
+        const ushort c = pos->unicode();
+        if (isCommand(c)) {
+            command = c;
+            ++pos;
+        } else if (command == 0 || command == 'Z' || command == 'z') {
+            return false;
+        }
+
+        if (command == 'Z' || command == 'z') {
+            char buffer[SegmentBufferSize];
+            const int length = formatSegment(writer, 'z', 0, 0, 0, precision, buffer, &writer);
+            append(&result, buffer, length);
+            x = startX;
+            y = startY;
+            outX = outStartX;
+            outY = outStartY;
+            continue;
+        }
+
+        // read the arguments
+        double args[7];
+        const int count = argumentCount(command);
+        for (int i = 0; i < count; ++i) {
+            skipSeparators(pos, end);
+            const bool isFlag = (command | 0x20) == 'a' && (i == 3 || i == 4);
+            if (isFlag ? !parseFlag(pos, end, &args[i]) : !parseNumber(pos, end, &args[i]))
+                return false;
+        }
+        if (first && (command | 0x20) != 'm')
+            return false;
+
+        // absolute coordinates of the arguments
+        const bool relative = command >= 'a';
+        const ushort type = command | 0x20;
+        double abs[7];
+        memcpy(abs, args, sizeof(abs));
+        const double originX = relative ? x : dx;
+        const double originY = relative ? y : dy;
+        if (type == 'h') {
+            abs[0] = originX + args[0];
+            abs[1] = y;
+        } else if (type == 'v') {
+            abs[1] = originY + args[0];
+            abs[0] = x;
+        } else if (type == 'a') {
+            abs[5] += originX;
+            abs[6] += originY;
+        } else {
+            for (int i = 0; i < count; i += 2) {
+                abs[i] += originX;
+                abs[i + 1] += originY;
+            }
+        }
+
+        // the output coordinates, as values and relative to the output point
+        double absolute[7];
+        double delta[7];
+        int points = count;
+        int flagMask = 0;
+        char letter = char(type & ~0x20);
+        bool relativeAllowed = true;
+
+        if (type == 'h' || type == 'v' || type == 'l') {
+            const double targetX = roundNumber(abs[0], precision);
+            const double targetY = roundNumber(abs[1], precision);
+            if (targetY == outY) {
+                letter = 'H';
+                absolute[0] = targetX;
+                points = 1;
+            } else if (targetX == outX) {
+                letter = 'V';
+                absolute[0] = targetY;
+                points = 1;
+            } else {
+                letter = 'L';
+                absolute[0] = targetX;
+                absolute[1] = targetY;
+                points = 2;
+            }
+            for (int i = 0; i < points; ++i) {
+                const double origin = (letter == 'V' || i == 1) ? outY : outX;
+                delta[i] = absolute[i] - origin;
+                relativeAllowed = relativeAllowed && origin + delta[i] == absolute[i];
+            }
+            x = abs[0];
+            y = abs[1];
+        } else if (type == 'a') {
+            for (int i = 0; i < 5; ++i)
+                absolute[i] = delta[i] = args[i];
+            absolute[5] = roundNumber(abs[5], precision);
+            absolute[6] = roundNumber(abs[6], precision);
+            delta[5] = absolute[5] - outX;
+            delta[6] = absolute[6] - outY;
+            relativeAllowed = outX + delta[5] == absolute[5] && outY + delta[6] == absolute[6];
+            flagMask = (1 << 3) | (1 << 4);
+            x = abs[5];
+            y = abs[6];
+        } else {
+            for (int i = 0; i < count; i += 2) {
+                absolute[i] = roundNumber(abs[i], precision);
+                absolute[i + 1] = roundNumber(abs[i + 1], precision);
+                delta[i] = absolute[i] - outX;
+                delta[i + 1] = absolute[i + 1] - outY;
+                relativeAllowed = relativeAllowed && outX + delta[i] == absolute[i]
+                                  && outY + delta[i + 1] == absolute[i + 1];
+            }
+            x = abs[count - 2];
+            y = abs[count - 1];
+        }
+
+        // when rounding anyway the relative form may lose a last bit
+        if (precision >= 0)
+            relativeAllowed = true;
+
+        // pick the shorter form, on a tie the one which needs no letter
+        char absoluteText[SegmentBufferSize];
+        char relativeText[SegmentBufferSize];
+        PathWriter absoluteState;
+        PathWriter relativeState;
+        const int absoluteLength = formatSegment(writer, letter, absolute, points, flagMask,
+                                                 precision, absoluteText, &absoluteState);
+        int relativeLength = -1;
+        if (relativeAllowed && !first)
+            relativeLength = formatSegment(writer, char(letter | 0x20), delta, points, flagMask,
+                                           precision, relativeText, &relativeState);
+
+        if (relativeLength >= 0 && (relativeLength < absoluteLength
+                                    || (relativeLength == absoluteLength
+                                        && writer.implicitCommand == char(letter | 0x20)))) {
+            append(&result, relativeText, relativeLength);
+            writer = relativeState;
+        } else {
+            append(&result, absoluteText, absoluteLength);
+            writer = absoluteState;
+        }
+
+        // the rounded end point is where the output continues from
+        if (type == 'h' || type == 'v' || type == 'l') {
+            if (letter != 'V')
+                outX = absolute[0];
+            if (letter == 'V')
+                outY = absolute[0];
+            else if (letter == 'L')
+                outY = absolute[1];
+        } else {
+            outX = absolute[points - 2];
+            outY = absolute[points - 1];
+        }
+
+        if (type == 'm') {
+            startX = x;
+            startY = y;
+            outStartX = outX;
+            outStartY = outY;
+            // further coordinate pairs are line segments
+            command = relative ? 'l' : 'L';
+        }
+        first = false;
+    }
+
+    return true;
+}
+
+QString optimizePathData(const QStringRef &data, int precision, double dx, double dy, bool *ok)
+{
+    QString result;
+    const bool success = optimize(data, precision, dx, dy, &result);
+    if (ok)
+        *ok = success;
+    return success ? result : data.toString();
+}
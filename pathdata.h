@@ -0,0 +1,40 @@
+/*
+  SVGMin - Aggressive SVG minifier
+
+  Copyright (C) 2009 Ariya Hidayat (ariya.hidayat@gmail.com)
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#ifndef PATHDATA_H
+#define PATHDATA_H
+
+#include <QtCore/QString>
+
+// Rewrites path data (the "d" attribute) in its shortest form: every segment
+// is written either absolute or relative, whichever is shorter, repeated
+// command letters and unneeded separators are omitted and lines parallel to
+// an axis become H or V. Numbers are rounded to the given number of decimals,
+// a negative precision keeps them exact. The path is moved by (dx, dy),
+// which flattens a translation into its coordinates.
+// Returns the input unchanged if it can not be parsed.
+QString optimizePathData(const QStringRef &data, int precision,
+                         double dx = 0, double dy = 0, bool *ok = 0);
+
+#endif
@@ -0,0 +1,183 @@
+/*
+  SVGMin - Aggressive SVG minifier
+
+  Copyright (C) 2009 Ariya Hidayat (ariya.hidayat@gmail.com)
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include "pngrecompressor.h"
+
+#include "compression.h"
+
+static const char signature[] = "\x89PNG\r\n\x1a\n";
+static const int signatureSize = 8;
+
+// what is inflated at most, which keeps a deflate bomb in the image data
+// from taking all memory
+static const qint64 maximumImageDataSize = 256 * 1024 * 1024;
+
+static quint32 readNumber(const char *data)
+{
+    const uchar *bytes = reinterpret_cast<const uchar *>(data);
+    return (quint32(bytes[0]) << 24) | (quint32(bytes[1]) << 16)
+        | (quint32(bytes[2]) << 8) | quint32(bytes[3]);
+}
+
+static void appendNumber(QByteArray *data, quint32 number)
+{
+    data->append(char(number >> 24));
+    data->append(char(number >> 16));
+    data->append(char(number >> 8));
+    data->append(char(number));
+}
+
+static void appendChunk(QByteArray *png, const QByteArray &type, const QByteArray &content)
+{
+    appendNumber(png, quint32(content.size()));
+    const QByteArray checked = type + content;
+    png->append(checked);
+    appendNumber(png, crc32Checksum(checked));
+}
+
+// ancillary chunks which change how the pixels are shown
+static bool isKept(const QByteArray &type)
+{
+    static const char *const names[] = { "cHRM", "gAMA", "iCCP", "sBIT", "sRGB", "tRNS" };
+    for (unsigned i = 0; i < sizeof(names) / sizeof(names[0]); ++i)
+        if (type == names[i])
+            return true;
+    return false;
+}
+
+// The size of the filtered image data which the header describes, -1 if
+// it is not valid or too large to hold. Every row starts with the filter
+// type, an interlaced image has seven passes with rows of their own.
+static qint64 imageDataSize(const QByteArray &header)
+{
+    if (header.size() != 13)
+        return -1;
+    const qint64 width = readNumber(header.constData());
+    const qint64 height = readNumber(header.constData() + 4);
+    const int depth = uchar(header.at(8));
+    int channels;
+    switch (header.at(9)) {
+    case 0: channels = 1; break;
+    case 2: channels = 3; break;
+    case 3: channels = 1; break;
+    case 4: channels = 2; break;
+    case 6: channels = 4; break;
+    default: return -1;
+    }
+    if (width == 0 || height == 0 || depth == 0 || depth > 16 || uchar(header.at(12)) > 1)
+        return -1;
+
+    static const int passes[7][4] = {
+        { 0, 0, 8, 8 }, { 4, 0, 8, 8 }, { 0, 4, 4, 8 }, { 2, 0, 4, 4 },
+        { 0, 2, 2, 4 }, { 1, 0, 2, 2 }, { 0, 1, 1, 2 }
+    };
+    static const int progressive[1][4] = { { 0, 0, 1, 1 } };
+    const bool interlaced = header.at(12) == 1;
+    const int (*steps)[4] = interlaced ? passes : progressive;
+    const int count = interlaced ? 7 : 1;
+
+    qint64 size = 0;
+    for (int i = 0; i < count; ++i) {
+        const qint64 columns = (width - steps[i][0] + steps[i][2] - 1) / steps[i][2];
+        const qint64 rows = (height - steps[i][1] + steps[i][3] - 1) / steps[i][3];
+        if (columns <= 0 || rows <= 0)
+            continue;
+        size += rows * (1 + (columns * channels * depth + 7) / 8);
+        if (size > maximumImageDataSize)
+            return -1;
+    }
+    return size;
+}
+
+QByteArray recompressedPng(const QByteArray &png)
+{
+    if (png.size() < signatureSize || !png.startsWith(QByteArray(signature, signatureSize)))
+        return QByteArray();
+
+    // the chunks up to and after the image data, which is merged into one
+    QByteArray head;
+    QByteArray tail;
+    QByteArray deflated;
+    qint64 expectedSize = -1;
+    bool ended = false;
+    int pos = signatureSize;
+    while (!ended) {
+        if (png.size() - pos < 12)
+            return QByteArray();
+        const quint32 length = readNumber(png.constData() + pos);
+        if (length > quint32(png.size() - pos - 12))
+            return QByteArray();
+        const QByteArray type = png.mid(pos + 4, 4);
+        const QByteArray content = png.mid(pos + 8, int(length));
+        if (readNumber(png.constData() + pos + 8 + length) != crc32Checksum(png.mid(pos + 4, int(length) + 4)))
+            return QByteArray();
+        pos += 12 + int(length);
+
+        // lower case marks an ancillary chunk; animated PNG files are
+        // left alone, since their frames are in chunks of their own
+        const bool critical = type.at(0) >= 'A' && type.at(0) <= 'Z';
+        if (type == "acTL")
+            return QByteArray();
+        if (type == "IHDR") {
+            if (pos != signatureSize + 25)
+                return QByteArray();
+            expectedSize = imageDataSize(content);
+        }
+        if (type == "IDAT") {
+            if (!tail.isEmpty())
+                return QByteArray();
+            deflated += content;
+        } else if (type == "IEND") {
+            ended = true;
+        } else if (critical && type != "IHDR" && type != "PLTE") {
+            return QByteArray();
+        } else if (critical || isKept(type)) {
+            QByteArray *chunks = deflated.isEmpty() ? &head : &tail;
+            appendChunk(chunks, type, content);
+        }
+    }
+    if (head.isEmpty() || deflated.isEmpty() || expectedSize < 0)
+        return QByteArray();
+
+    bool ok;
+    const QByteArray pixels = zlibUncompress(deflated, &ok, int(expectedSize));
+    if (!ok || pixels.size() != expectedSize)
+        return QByteArray();
+    QByteArray best = zlibCompress(pixels, 9, false);
+    const QByteArray filtered = zlibCompress(pixels, 9, true);
+    if (best.isEmpty() || (!filtered.isEmpty() && filtered.size() < best.size()))
+        best = filtered;
+    if (best.isEmpty())
+        return QByteArray();
+
+    QByteArray result(signature, signatureSize);
+    result.reserve(png.size());
+    result += head;
+    appendChunk(&result, "IDAT", best);
+    result += tail;
+    appendChunk(&result, "IEND", QByteArray());
+    if (result.size() >= png.size())
+        return QByteArray();
+    return result;
+}
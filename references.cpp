@@ -0,0 +1,121 @@
+/*
+  SVGMin - Aggressive SVG minifier
+
+  Copyright (C) 2009 Ariya Hidayat (ariya.hidayat@gmail.com)
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include "references.h"
+
+bool isHref(const QStringRef &name)
+{
+    const int size = name.size();
+    if (size < 4)
+        return false;
+    const QChar *unicode = name.unicode();
+    if (size > 4 && unicode[size - 5].unicode() != ':')
+        return false;
+    return unicode[size - 4].unicode() == 'h' && unicode[size - 3].unicode() == 'r'
+        && unicode[size - 2].unicode() == 'e' && unicode[size - 1].unicode() == 'f';
+}
+
+static inline bool isSpace(ushort c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f';
+}
+
+// whether the '#' at pos follows "url(", maybe with a quote and spaces
+static bool inUrl(const QChar *begin, const QChar *pos)
+{
+    while (pos > begin && isSpace(pos[-1].unicode()))
+        --pos;
+    if (pos > begin && (pos[-1].unicode() == '"' || pos[-1].unicode() == '\''))
+        --pos;
+    while (pos > begin && isSpace(pos[-1].unicode()))
+        --pos;
+    return pos - begin >= 4 && pos[-4].unicode() == 'u' && pos[-3].unicode() == 'r'
+        && pos[-2].unicode() == 'l' && pos[-1].unicode() == '(';
+}
+
+static inline bool endsId(ushort c)
+{
+    return c == ')' || c == '"' || c == '\'' || c == ';' || c == ',' || isSpace(c);
+}
+
+// finds the next reference from pos on, returns false if there is none
+static bool findReference(const QChar *begin, const QChar *end, bool href,
+                          const QChar **pos, const QChar **idEnd)
+{
+    for (const QChar *p = *pos; p < end; ++p) {
+        if (p->unicode() != '#')
+            continue;
+        const bool whole = href && p == begin;
+        if (!whole && !inUrl(begin, p))
+            continue;
+        const QChar *e = p + 1;
+        while (e < end && (whole || !endsId(e->unicode())))
+            ++e;
+        *pos = p + 1;
+        *idEnd = e;
+        return true;
+    }
+    return false;
+}
+
+bool remapReferences(const QStringRef &value, bool href, const QHash<QString, QString> &ids,
+                     QString *result)
+{
+    const QChar *begin = value.unicode();
+    const QChar *end = begin + value.size();
+    const QChar *copied = begin;
+    QString text;
+
+    const QChar *id = begin;
+    const QChar *idEnd;
+    while (findReference(begin, end, href, &id, &idEnd)) {
+        const QHash<QString, QString>::const_iterator it
+            = ids.constFind(QString(id, int(idEnd - id)));
+        if (it != ids.constEnd()) {
+            text += QString(copied, int(id - copied));
+            text.append(it.value());
+            copied = idEnd;
+        }
+        id = idEnd;
+    }
+
+    if (copied == begin)
+        return false;
+    text += QString(copied, int(end - copied));
+    *result = text;
+    return true;
+}
+
+void collectReferences(const QStringRef &value, bool href, QStringList *ids)
+{
+    const QChar *begin = value.unicode();
+    const QChar *end = begin + value.size();
+
+    const QChar *id = begin;
+    const QChar *idEnd;
+    while (findReference(begin, end, href, &id, &idEnd)) {
+        ids->append(QString(id, int(idEnd - id)));
+        id = idEnd;
+    }
+}
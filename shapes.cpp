@@ -0,0 +1,131 @@
+/*
+  SVGMin - Aggressive SVG minifier
+
+  Copyright (C) 2009 Ariya Hidayat (ariya.hidayat@gmail.com)
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include "shapes.h"
+
+#include "numberformat.h"
+#include "pathdata.h"
+
+// a missing coordinate is zero
+static bool coordinate(const QXmlStreamAttributes &attributes, const char *name, double *value)
+{
+    const QStringRef text = attributes.value(QLatin1String(name));
+    *value = 0;
+    return text.isNull() || parseNumber(text, value);
+}
+
+static int coordinateCount(const QStringRef &points)
+{
+    const QChar *pos = points.unicode();
+    const QChar *end = pos + points.size();
+    int count = 0;
+    double value;
+    while (count < 4) {
+        while (pos < end && (pos->unicode() == ',' || pos->unicode() <= ' '))
+            ++pos;
+        if (pos == end || !parseNumber(pos, end, &value))
+            break;
+        ++count;
+    }
+    return count;
+}
+
+static void appendCommand(QString *path, char command, const double *values, int count)
+{
+    path->append(QLatin1Char(command));
+    appendNumbers(path, values, count, -1);
+}
+
+bool shapePathData(const QStringRef &name, const QXmlStreamAttributes &attributes,
+                   int precision, QString *path)
+{
+    QString source;
+
+    if (name == QLatin1String("rect")) {
+        double v[4];
+        if (!coordinate(attributes, "x", &v[0]) || !coordinate(attributes, "y", &v[1])
+            || !coordinate(attributes, "width", &v[2]) || !coordinate(attributes, "height", &v[3]))
+            return false;
+        // an empty rect is not rendered at all, unlike an empty path
+        if (v[2] <= 0 || v[3] <= 0)
+            return false;
+        double radius;
+        if (!coordinate(attributes, "rx", &radius) || radius != 0)
+            return false;
+        if (!coordinate(attributes, "ry", &radius) || radius != 0)
+            return false;
+        // as in SVG 2, clockwise from the top left corner
+        const double right = v[0] + v[2];
+        const double bottom = v[1] + v[3];
+        appendCommand(&source, 'M', v, 2);
+        appendCommand(&source, 'H', &right, 1);
+        appendCommand(&source, 'V', &bottom, 1);
+        appendCommand(&source, 'H', v, 1);
+        source.append(QLatin1Char('z'));
+    } else if (name == QLatin1String("line")) {
+        double v[4];
+        if (!coordinate(attributes, "x1", &v[0]) || !coordinate(attributes, "y1", &v[1])
+            || !coordinate(attributes, "x2", &v[2]) || !coordinate(attributes, "y2", &v[3]))
+            return false;
+        appendCommand(&source, 'M', v, 2);
+        appendCommand(&source, 'L', v + 2, 2);
+    } else if (name == QLatin1String("polyline") || name == QLatin1String("polygon")) {
+        // the points grammar is that of the arguments of moveto
+        const QStringRef points = attributes.value(QLatin1String("points"));
+        // with a single point nothing is rendered, a path would draw caps
+        if (coordinateCount(points) < 4)
+            return false;
+        source = QLatin1Char('M') + points.toString();
+        if (name == QLatin1String("polygon"))
+            source.append(QLatin1Char('z'));
+    } else {
+        return false;
+    }
+
+    bool ok;
+    *path = optimizePathData(QStringRef(&source), precision, 0, 0, &ok);
+    return ok;
+}
+
+bool isShapeGeometry(const QStringRef &name, const QStringRef &attribute)
+{
+    static const char *const rect[] = { "x", "y", "width", "height", "rx", "ry", 0 };
+    static const char *const line[] = { "x1", "y1", "x2", "y2", 0 };
+    static const char *const points[] = { "points", 0 };
+
+    const char *const *names;
+    if (name == QLatin1String("rect"))
+        names = rect;
+    else if (name == QLatin1String("line"))
+        names = line;
+    else if (name == QLatin1String("polyline") || name == QLatin1String("polygon"))
+        names = points;
+    else
+        return false;
+
+    for (int i = 0; names[i]; ++i)
+        if (attribute == QLatin1String(names[i]))
+            return true;
+    return false;
+}
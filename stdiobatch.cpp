@@ -0,0 +1,266 @@
+/*
+  SVGMin - Aggressive SVG minifier
+
+  Copyright (C) 2009 Ariya Hidayat (ariya.hidayat@gmail.com)
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include "stdiobatch.h"
+
+#include <QtCore/QByteArray>
+#include <QtCore/QFile>
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <QtCore/QRunnable>
+#include <QtCore/QSemaphore>
+#include <QtCore/QThreadPool>
+
+#include <stdio.h>
+
+#include "compression.h"
+#include "options.h"
+#include "svgminifier.h"
+
+// well below INT_MAX, which is the most a QByteArray can hold
+static const quint32 MaximumFrameSize = 256 * 1024 * 1024;
+static const int SkipChunkSize = 64 * 1024;
+
+class StdioBatch::Private
+{
+public:
+    Private(const SvgMinifier &config) : minifier(config), inputDevice(0), outputDevice(0) {}
+
+    bool readFully(char *buffer, qint64 size);
+    bool readNumber(quint32 *value);
+    bool readFrame(QByteArray *data, quint32 size, bool *fits);
+    void writeResponse(quint32 id, quint32 status, const QByteArray &document);
+
+    SvgMinifier minifier;
+    QIODevice *inputDevice;
+    QIODevice *outputDevice;
+    bool ok;
+
+    QThreadPool pool;
+    QSemaphore slots;
+    QMutex outputMutex;
+};
+
+class BatchJob : public QRunnable
+{
+public:
+    BatchJob(StdioBatch::Private *batch, quint32 id,
+             const QByteArray &options, const QByteArray &document);
+
+    void run();
+
+private:
+    StdioBatch::Private *batch;
+    quint32 id;
+    QByteArray options;
+    QByteArray document;
+};
+
+BatchJob::BatchJob(StdioBatch::Private *b, quint32 i, const QByteArray &o, const QByteArray &doc)
+    : batch(b), id(i), options(o), document(doc)
+{
+}
+
+void BatchJob::run()
+{
+    SvgMinifier minifier(batch->minifier);
+
+    foreach (const QByteArray &line, options.split('\n')) {
+        const QString option = QString::fromUtf8(line.trimmed());
+        if (option.isEmpty())
+            continue;
+        if (!applyOption(&minifier, option)) {
+            batch->writeResponse(id, StdioBatch::InvalidOption, document);
+            return;
+        }
+    }
+
+    bool ok = true;
+    const bool compressed = isGzipped(document);
+    QByteArray result = document;
+    if (compressed)
+        result = gzipUncompress(document, &ok);
+    if (ok)
+        result = minifier.minify(result, &ok);
+    if (ok && compressed) {
+        result = gzipCompress(result);
+        ok = !result.isEmpty();
+    }
+
+    if (ok)
+        batch->writeResponse(id, StdioBatch::Ok, result);
+    else
+        batch->writeResponse(id, StdioBatch::ParseError, document);
+}
+
+static void appendNumber(QByteArray *data, quint32 value)
+{
+    data->append(char(value >> 24));
+    data->append(char(value >> 16));
+    data->append(char(value >> 8));
+    data->append(char(value));
+}
+
+StdioBatch::StdioBatch(const SvgMinifier &minifier)
+{
+    d = new Private(minifier);
+}
+
+StdioBatch::~StdioBatch()
+{
+    delete d;
+}
+
+void StdioBatch::setInputDevice(QIODevice *device)
+{
+    d->inputDevice = device;
+}
+
+void StdioBatch::setOutputDevice(QIODevice *device)
+{
+    d->outputDevice = device;
+}
+
+bool StdioBatch::Private::readFully(char *buffer, qint64 size)
+{
+    while (size > 0) {
+        const qint64 count = inputDevice->read(buffer, size);
+        if (count <= 0)
+            return false;
+        buffer += count;
+        size -= count;
+    }
+    return true;
+}
+
+bool StdioBatch::Private::readNumber(quint32 *value)
+{
+    uchar bytes[4];
+    if (!readFully(reinterpret_cast<char *>(bytes), 4))
+        return false;
+    *value = (quint32(bytes[0]) << 24) | (quint32(bytes[1]) << 16)
+             | (quint32(bytes[2]) << 8) | quint32(bytes[3]);
+    return true;
+}
+
+bool StdioBatch::Private::readFrame(QByteArray *data, quint32 size, bool *fits)
+{
+    if (size <= MaximumFrameSize) {
+        data->resize(int(size));
+        return readFully(data->data(), size);
+    }
+
+    *fits = false;
+    char buffer[SkipChunkSize];
+    while (size > 0) {
+        const quint32 chunk = qMin(size, quint32(SkipChunkSize));
+        if (!readFully(buffer, chunk))
+            return false;
+        size -= chunk;
+    }
+    return true;
+}
+
+void StdioBatch::Private::writeResponse(quint32 id, quint32 status, const QByteArray &document)
+{
+    QByteArray header;
+    header.reserve(12);
+    appendNumber(&header, id);
+    appendNumber(&header, status);
+    appendNumber(&header, document.size());
+
+    QMutexLocker lock(&outputMutex);
+    if (outputDevice->write(header) != header.size()
+        || outputDevice->write(document) != document.size())
+        ok = false;
+
+    // the client is waiting for this very response
+    QFile *file = qobject_cast<QFile *>(outputDevice);
+    if (file)
+        file->flush();
+
+    slots.release();
+}
+
+bool StdioBatch::run()
+{
+    // fall back to standard input
+    QFile standardInput;
+    if (!d->inputDevice) {
+        standardInput.open(stdin, QFile::ReadOnly | QFile::Unbuffered);
+        d->inputDevice = &standardInput;
+    }
+
+    // fall back to standard output
+    QFile standardOutput;
+    if (!d->outputDevice) {
+        standardOutput.open(stdout, QFile::WriteOnly);
+        d->outputDevice = &standardOutput;
+    }
+
+    // bound the number of requests held in memory
+    const int maxPendingRequests = 2 * qMax(1, d->pool.maxThreadCount());
+    d->slots.release(maxPendingRequests);
+    d->ok = true;
+
+    for (;;) {
+        quint32 id;
+        if (!d->readNumber(&id))
+            break;
+
+        // an oversized frame is skipped rather than buffered, so that the
+        // stream stays in sync and the client gets a response for it
+        quint32 size;
+        bool fits = true;
+        QByteArray options;
+        QByteArray document;
+        if (!d->readNumber(&size) || !d->readFrame(&options, size, &fits)
+            || !d->readNumber(&size) || !d->readFrame(&document, size, &fits)) {
+            d->ok = false;
+            break;
+        }
+
+        if (!fits) {
+            d->slots.acquire();
+            d->writeResponse(id, StdioBatch::TooLarge, QByteArray());
+            continue;
+        }
+
+        d->slots.acquire();
+        d->pool.start(new BatchJob(d, id, options, document));
+    }
+
+    d->pool.waitForDone();
+
+    if (standardInput.isOpen()) {
+        standardInput.close();
+        d->inputDevice = 0;
+    }
+    if (standardOutput.isOpen()) {
+        standardOutput.close();
+        d->outputDevice = 0;
+    }
+
+    return d->ok;
+}
@@ -0,0 +1,69 @@
+/*
+  SVGMin - Aggressive SVG minifier
+
+  Copyright (C) 2009 Ariya Hidayat (ariya.hidayat@gmail.com)
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#ifndef STDIOBATCH_H
+#define STDIOBATCH_H
+
+#include <QtCore/QIODevice>
+
+class SvgMinifier;
+
+// Co-process mode, so that a single long-lived process can serve all the
+// documents of a build. Every integer is an unsigned 32-bit big-endian value.
+//
+// Request:  id, options size, options, document size, document
+// Response: id, status, document size, document
+//
+// The options are command line options (e.g. "--remove-metadata") separated
+// by newlines, applied on top of the options the process was started with.
+// Requests are processed concurrently and each response is written as soon
+// as it is ready, so the client may pipeline requests but has to match the
+// responses by id. A gzip compressed request gets a gzip compressed response.
+// For any status other than Ok the document is sent back unchanged, except
+// for TooLarge (options or document above 256 MiB) where it is left empty.
+class StdioBatch
+{
+public:
+    enum Status {
+        Ok = 0,
+        ParseError = 1,
+        InvalidOption = 2,
+        TooLarge = 3
+    };
+
+    StdioBatch(const SvgMinifier &minifier);
+    ~StdioBatch();
+
+    void setInputDevice(QIODevice *device);
+    void setOutputDevice(QIODevice *device);
+
+    bool run();
+
+    class Private;
+
+private:
+    Private *d;
+};
+
+#endif
@@ -0,0 +1,95 @@
+/*
+  SVGMin - Aggressive SVG minifier
+
+  Copyright (C) 2009 Ariya Hidayat (ariya.hidayat@gmail.com)
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#ifndef STREAMPASS_H
+#define STREAMPASS_H
+
+#include <QtCore/QList>
+#include <QtCore/QString>
+#include <QtCore/QXmlStreamReader>
+
+// A token of the input as the passes see it. The names and the text refer
+// to the buffer of the reader and are only valid during the call.
+struct StreamEvent
+{
+    enum Type {
+        StartElement,
+        EndElement,
+        Characters,
+        ProcessingInstruction
+    };
+
+    Type type;
+
+    // the element, or the target of a processing instruction
+    QStringRef qualifiedName;
+    QStringRef prefix;
+    QStringRef name;
+
+    // those of a start element, which the passes may change
+    QXmlStreamAttributes *attributes;
+
+    // the characters, or the data of a processing instruction
+    QStringRef text;
+
+    // set by a pass to leave out a start element together with its
+    // content, the characters or the processing instruction
+    bool dropped;
+};
+
+// A stage of the minifier which looks at one token at a time, such as the
+// removal of editor data, metadata and excluded ids or the conversion of
+// style properties. Stages which need the pre-scan, the computed style or
+// the held back groups are still part of the writer. The passes of a
+// chain see every event in document order, one pass after the other,
+// before the event is written; the content of a dropped element does not
+// reach any pass.
+class StreamPass
+{
+public:
+    virtual ~StreamPass();
+
+    virtual void process(StreamEvent *event) = 0;
+};
+
+class PassChain
+{
+public:
+    PassChain();
+    ~PassChain();
+
+    // takes ownership of the pass, which comes after those added before
+    void append(StreamPass *pass);
+    bool isEmpty() const;
+
+    // stops at the first pass which drops the event
+    void process(StreamEvent *event);
+
+private:
+    Q_DISABLE_COPY(PassChain)
+
+    QList<StreamPass *> passes;
+};
+
+#endif
@@ -0,0 +1,509 @@
+/*
+  SVGMin - Aggressive SVG minifier
+
+  Copyright (C) 2009 Ariya Hidayat (ariya.hidayat@gmail.com)
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include "svgcolor.h"
+
+struct NamedColor
+{
+    const char *name;
+    uint rgb;
+};
+
+// The 147 SVG color keywords in a perfect hash table: the first hash of a
+// name picks a seed for the second one, which gives its slot. Generated
+// offline, the seeds are chosen such that no two names share a slot.
+enum { SeedCount = 64, SlotCount = 256 };
+
+static const uchar seeds[SeedCount] = {
+    0, 0, 0, 6, 1, 2, 1, 0, 8, 4, 1, 0, 2, 1, 2, 2,
+    2, 1, 3, 2, 2, 3, 1, 2, 4, 1, 1, 0, 2, 7, 4, 3,
+    3, 0, 1, 0, 3, 0, 1, 2, 1, 2, 1, 1, 1, 2, 1, 8,
+    3, 1, 1, 5, 8, 1, 1, 3, 0, 7, 1, 1, 1, 5, 1, 7
+};
+
+static const NamedColor namedColors[SlotCount] = {
+    { 0, 0 },
+    { "aquamarine", 0x7fffd4 },
+    { 0, 0 },
+    { "darkgrey", 0xa9a9a9 },
+    { "whitesmoke", 0xf5f5f5 },
+    { 0, 0 },
+    { "lightcoral", 0xf08080 },
+    { "snow", 0xfffafa },
+    { "linen", 0xfaf0e6 },
+    { "mediumturquoise", 0x48d1cc },
+    { "mintcream", 0xf5fffa },
+    { "coral", 0xff7f50 },
+    { 0, 0 },
+    { "fuchsia", 0xff00ff },
+    { "thistle", 0xd8bfd8 },
+    { 0, 0 },
+    { "darkseagreen", 0x8fbc8f },
+    { 0, 0 },
+    { "lightslategrey", 0x778899 },
+    { "lightsteelblue", 0xb0c4de },
+    { "darkblue", 0x00008b },
+    { 0, 0 },
+    { "darkred", 0x8b0000 },
+    { 0, 0 },
+    { 0, 0 },
+    { 0, 0 },
+    { 0, 0 },
+    { "lightsalmon", 0xffa07a },
+    { 0, 0 },
+    { "lime", 0x00ff00 },
+    { "palevioletred", 0xdb7093 },
+    { "pink", 0xffc0cb },
+    { "cornflowerblue", 0x6495ed },
+    { "lemonchiffon", 0xfffacd },
+    { 0, 0 },
+    { 0, 0 },
+    { 0, 0 },
+    { 0, 0 },
+    { 0, 0 },
+    { 0, 0 },
+    { "slategray", 0x708090 },
+    { "darkturquoise", 0x00ced1 },
+    { "seashell", 0xfff5ee },
+    { "greenyellow", 0xadff2f },
+    { "darksalmon", 0xe9967a },
+    { "dimgrey", 0x696969 },
+    { 0, 0 },
+    { "lightskyblue", 0x87cefa },
+    { 0, 0 },
+    { "rosybrown", 0xbc8f8f },
+    { 0, 0 },
+    { 0, 0 },
+    { 0, 0 },
+    { "firebrick", 0xb22222 },
+    { "olivedrab", 0x6b8e23 },
+    { "dodgerblue", 0x1e90ff },
+    { 0, 0 },
+    { "saddlebrown", 0x8b4513 },
+    { "olive", 0x808000 },
+    { 0, 0 },
+    { 0, 0 },
+    { "goldenrod", 0xdaa520 },
+    { "mediumaquamarine", 0x66cdaa },
+    { 0, 0 },
+    { "lightgrey", 0xd3d3d3 },
+    { "black", 0x000000 },
+    { 0, 0 },
+    { 0, 0 },
+    { 0, 0 },
+    { 0, 0 },
+    { 0, 0 },
+    { 0, 0 },
+    { "skyblue", 0x87ceeb },
+    { 0, 0 },
+    { "indianred", 0xcd5c5c },
+    { 0, 0 },
+    { 0, 0 },
+    { 0, 0 },
+    { "mediumseagreen", 0x3cb371 },
+    { "bisque", 0xffe4c4 },
+    { 0, 0 },
+    { "white", 0xffffff },
+    { "cadetblue", 0x5f9ea0 },
+    { "lavender", 0xe6e6fa },
+    { 0, 0 },
+    { "turquoise", 0x40e0d0 },
+    { "plum", 0xdda0dd },
+    { "sandybrown", 0xf4a460 },
+    { "ghostwhite", 0xf8f8ff },
+    { 0, 0 },
+    { 0, 0 },
+    { "blueviolet", 0x8a2be2 },
+    { "teal", 0x008080 },
+    { 0, 0 },
+    { "lightcyan", 0xe0ffff },
+    { "grey", 0x808080 },
+    { "lightyellow", 0xffffe0 },
+    { 0, 0 },
+    { "wheat", 0xf5deb3 },
+    { 0, 0 },
+    { "darkkhaki", 0xbdb76b },
+    { 0, 0 },
+    { 0, 0 },
+    { 0, 0 },
+    { "navy", 0x000080 },
+    { "springgreen", 0x00ff7f },
+    { 0, 0 },
+    { "gray", 0x808080 },
+    { "lightgoldenrodyellow", 0xfafad2 },
+    { 0, 0 },
+    { 0, 0 },
+    { 0, 0 },
+    { 0, 0 },
+    { "ivory", 0xfffff0 },
+    { "palegoldenrod", 0xeee8aa },
+    { 0, 0 },
+    { "mediumblue", 0x0000cd },
+    { 0, 0 },
+    { 0, 0 },
+    { 0, 0 },
+    { "peachpuff", 0xffdab9 },
+    { "moccasin", 0xffe4b5 },
+    { "chartreuse", 0x7fff00 },
+    { "magenta", 0xff00ff },
+    { "blanchedalmond", 0xffebcd },
+    { 0, 0 },
+    { 0, 0 },
+    { 0, 0 },
+    { "deeppink", 0xff1493 },
+    { "slateblue", 0x6a5acd },
+    { 0, 0 },
+    { "darkorchid", 0x9932cc },
+    { "hotpink", 0xff69b4 },
+    { "gold", 0xffd700 },
+    { "palegreen", 0x98fb98 },
+    { 0, 0 },
+    { "blue", 0x0000ff },
+    { 0, 0 },
+    { 0, 0 },
+    { 0, 0 },
+    { "darkolivegreen", 0x556b2f },
+    { "yellow", 0xffff00 },
+    { "lightpink", 0xffb6c1 },
+    { "darkcyan", 0x008b8b },
+    { "beige", 0xf5f5dc },
+    { "azure", 0xf0ffff },
+    { "mistyrose", 0xffe4e1 },
+    { 0, 0 },
+    { "darkslategray", 0x2f4f4f },
+    { "orangered", 0xff4500 },
+    { 0, 0 },
+    { "mediumpurple", 0x9370db },
+    { "gainsboro", 0xdcdcdc },
+    { 0, 0 },
+    { "indigo", 0x4b0082 },
+    { "darkgreen", 0x006400 },
+    { 0, 0 },
+    { "paleturquoise", 0xafeeee },
+    { 0, 0 },
+    { 0, 0 },
+    { 0, 0 },
+    { "crimson", 0xdc143c },
+    { "slategrey", 0x708090 },
+    { "royalblue", 0x4169e1 },
+    { "seagreen", 0x2e8b57 },
+    { "mediumspringgreen", 0x00fa9a },
+    { "darkslategrey", 0x2f4f4f },
+    { "papayawhip", 0xffefd5 },
+    { 0, 0 },
+    { "mediumvioletred", 0xc71585 },
+    { 0, 0 },
+    { "cornsilk", 0xfff8dc },
+    { 0, 0 },
+    { "mediumslateblue", 0x7b68ee },
+    { "red", 0xff0000 },
+    { "burlywood", 0xdeb887 },
+    { "khaki", 0xf0e68c },
+    { "navajowhite", 0xffdead },
+    { "darkorange", 0xff8c00 },
+    { 0, 0 },
+    { "midnightblue", 0x191970 },
+    { "darkgoldenrod", 0xb8860b },
+    { "lavenderblush", 0xfff0f5 },
+    { 0, 0 },
+    { 0, 0 },
+    { "lightslategray", 0x778899 },
+    { 0, 0 },
+    { 0, 0 },
+    { 0, 0 },
+    { 0, 0 },
+    { "orange", 0xffa500 },
+    { "darkmagenta", 0x8b008b },
+    { 0, 0 },
+    { "deepskyblue", 0x00bfff },
+    { 0, 0 },
+    { 0, 0 },
+    { 0, 0 },
+    { 0, 0 },
+    { 0, 0 },
+    { "brown", 0xa52a2a },
+    { 0, 0 },
+    { "antiquewhite", 0xfaebd7 },
+    { "oldlace", 0xfdf5e6 },
+    { 0, 0 },
+    { 0, 0 },
+    { "darkslateblue", 0x483d8b },
+    { "lightseagreen", 0x20b2aa },
+    { "violet", 0xee82ee },
+    { "yellowgreen", 0x9acd32 },
+    { 0, 0 },
+    { 0, 0 },
+    { "cyan", 0x00ffff },
+    { "honeydew", 0xf0fff0 },
+    { "peru", 0xcd853f },
+    { "chocolate", 0xd2691e },
+    { "lightgray", 0xd3d3d3 },
+    { "salmon", 0xfa8072 },
+    { 0, 0 },
+    { 0, 0 },
+    { "darkviolet", 0x9400d3 },
+    { "floralwhite", 0xfffaf0 },
+    { 0, 0 },
+    { 0, 0 },
+    { 0, 0 },
+    { "steelblue", 0x4682b4 },
+    { "tomato", 0xff6347 },
+    { 0, 0 },
+    { "mediumorchid", 0xba55d3 },
+    { 0, 0 },
+    { "powderblue", 0xb0e0e6 },
+    { 0, 0 },
+    { 0, 0 },
+    { 0, 0 },
+    { "lawngreen", 0x7cfc00 },
+    { 0, 0 },
+    { 0, 0 },
+    { "tan", 0xd2b48c },
+    { "aliceblue", 0xf0f8ff },
+    { "sienna", 0xa0522d },
+    { "green", 0x008000 },
+    { 0, 0 },
+    { "dimgray", 0x696969 },
+    { 0, 0 },
+    { "silver", 0xc0c0c0 },
+    { "lightblue", 0xadd8e6 },
+    { "forestgreen", 0x228b22 },
+    { 0, 0 },
+    { "darkgray", 0xa9a9a9 },
+    { "purple", 0x800080 },
+    { "limegreen", 0x32cd32 },
+    { 0, 0 },
+    { "lightgreen", 0x90ee90 },
+    { "maroon", 0x800000 },
+    { 0, 0 },
+    { "aqua", 0x00ffff },
+    { "orchid", 0xda70d6 }
+};
+
+// keywords which are shorter than the hexadecimal notation, by value
+static const NamedColor shortNames[] = {
+    { "navy", 0x000080 },
+    { "green", 0x008000 },
+    { "teal", 0x008080 },
+    { "indigo", 0x4b0082 },
+    { "maroon", 0x800000 },
+    { "purple", 0x800080 },
+    { "olive", 0x808000 },
+    { "gray", 0x808080 },
+    { "sienna", 0xa0522d },
+    { "brown", 0xa52a2a },
+    { "silver", 0xc0c0c0 },
+    { "peru", 0xcd853f },
+    { "tan", 0xd2b48c },
+    { "orchid", 0xda70d6 },
+    { "plum", 0xdda0dd },
+    { "violet", 0xee82ee },
+    { "khaki", 0xf0e68c },
+    { "azure", 0xf0ffff },
+    { "wheat", 0xf5deb3 },
+    { "beige", 0xf5f5dc },
+    { "salmon", 0xfa8072 },
+    { "linen", 0xfaf0e6 },
+    { "red", 0xff0000 },
+    { "tomato", 0xff6347 },
+    { "coral", 0xff7f50 },
+    { "orange", 0xffa500 },
+    { "pink", 0xffc0cb },
+    { "gold", 0xffd700 },
+    { "bisque", 0xffe4c4 },
+    { "snow", 0xfffafa },
+    { "ivory", 0xfffff0 }
+};
+
+// FNV-1a of the lowercase name
+static uint hash(const QChar *name, int length, uint seed)
+{
+    uint value = 2166136261u ^ seed;
+    for (int i = 0; i < length; ++i) {
+        ushort c = name[i].unicode();
+        if (c >= 'A' && c <= 'Z')
+            c |= 0x20;
+        value = (value ^ c) * 16777619u;
+    }
+    return value;
+}
+
+static bool namedColor(const QChar *name, int length, uint *rgb)
+{
+    if (length < 3 || length > 20)
+        return false;
+    const uint seed = seeds[hash(name, length, 0) % SeedCount];
+    const NamedColor &color = namedColors[hash(name, length, seed) % SlotCount];
+    if (!color.name)
+        return false;
+    for (int i = 0; i < length; ++i) {
+        ushort c = name[i].unicode();
+        if (c >= 'A' && c <= 'Z')
+            c |= 0x20;
+        if (c != uchar(color.name[i]))
+            return false;
+    }
+    if (color.name[length])
+        return false;
+    *rgb = color.rgb;
+    return true;
+}
+
+static int hexValue(ushort c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+static inline bool isSpace(ushort c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f';
+}
+
+static void skipSpaces(const QChar *&pos, const QChar *end)
+{
+    while (pos < end && isSpace(pos->unicode()))
+        ++pos;
+}
+
+// one component of rgb(), an integer or a percentage, clamped to 0..255
+static bool parseComponent(const QChar *&pos, const QChar *end, uint *component)
+{
+    skipSpaces(pos, end);
+    bool negative = false;
+    if (pos < end && (pos->unicode() == '-' || pos->unicode() == '+')) {
+        negative = pos->unicode() == '-';
+        ++pos;
+    }
+    const QChar *digits = pos;
+    uint value = 0;
+    while (pos < end && pos->unicode() >= '0' && pos->unicode() <= '9') {
+        value = qMin<uint>(value * 10 + (pos->unicode() - '0'), 100000);
+        ++pos;
+    }
+    if (pos == digits)
+        return false;
+    if (pos < end && pos->unicode() == '%') {
+        ++pos;
+        value = (qMin<uint>(value, 100) * 255 + 50) / 100;
+    } else if (pos < end && pos->unicode() == '.') {
+        // fractions would need rounding as the renderer does it
+        return false;
+    }
+    *component = negative ? 0 : qMin<uint>(value, 255);
+    skipSpaces(pos, end);
+    return true;
+}
+
+bool parseColor(const QStringRef &value, uint *rgb)
+{
+    const QChar *pos = value.unicode();
+    const QChar *end = pos + value.size();
+    skipSpaces(pos, end);
+    while (end > pos && isSpace(end[-1].unicode()))
+        --end;
+    const int length = int(end - pos);
+    if (length == 0)
+        return false;
+
+    if (pos->unicode() == '#') {
+        int digits[6];
+        for (int i = 1; i < length; ++i)
+            if (i > 6 || (digits[i - 1] = hexValue(pos[i].unicode())) < 0)
+                return false;
+        if (length == 4) {
+            *rgb = (digits[0] * 17 << 16) | (digits[1] * 17 << 8) | digits[2] * 17;
+            return true;
+        }
+        if (length == 7) {
+            *rgb = (digits[0] << 20) | (digits[1] << 16) | (digits[2] << 12)
+                 | (digits[3] << 8) | (digits[4] << 4) | digits[5];
+            return true;
+        }
+        return false;
+    }
+
+    if (length > 4 && (pos[0].unicode() | 0x20) == 'r' && (pos[1].unicode() | 0x20) == 'g'
+        && (pos[2].unicode() | 0x20) == 'b' && pos[3].unicode() == '(') {
+        pos += 4;
+        uint components[3];
+        for (int i = 0; i < 3; ++i) {
+            if (!parseComponent(pos, end, &components[i]))
+                return false;
+            if (i < 2) {
+                if (pos == end || pos->unicode() != ',')
+                    return false;
+                ++pos;
+            }
+        }
+        if (pos + 1 != end || pos->unicode() != ')')
+            return false;
+        *rgb = (components[0] << 16) | (components[1] << 8) | components[2];
+        return true;
+    }
+
+    return namedColor(pos, length, rgb);
+}
+
+QString colorText(uint rgb)
+{
+    int low = 0;
+    int high = int(sizeof(shortNames) / sizeof(shortNames[0])) - 1;
+    while (low <= high) {
+        const int middle = (low + high) / 2;
+        if (shortNames[middle].rgb == rgb)
+            return QLatin1String(shortNames[middle].name);
+        if (shortNames[middle].rgb < rgb)
+            low = middle + 1;
+        else
+            high = middle - 1;
+    }
+
+    static const char hex[] = "0123456789abcdef";
+    char text[8];
+    text[0] = '#';
+    for (int i = 0; i < 6; ++i)
+        text[i + 1] = hex[(rgb >> (20 - 4 * i)) & 15];
+    text[7] = '\0';
+    if (text[1] == text[2] && text[3] == text[4] && text[5] == text[6]) {
+        text[2] = text[3];
+        text[3] = text[5];
+        text[4] = '\0';
+    }
+    return QLatin1String(text);
+}
+
+bool shortenColor(const QStringRef &value, QString *buffer)
+{
+    uint rgb;
+    if (!parseColor(value, &rgb))
+        return false;
+    buffer->append(colorText(rgb));
+    return true;
+}
@@ -0,0 +1,41 @@
+/*
+  SVGMin - Aggressive SVG minifier
+
+  Copyright (C) 2009 Ariya Hidayat (ariya.hidayat@gmail.com)
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#ifndef SVGCOLOR_H
+#define SVGCOLOR_H
+
+#include <QtCore/QString>
+
+// Parses "#rgb", "#rrggbb", "rgb(r, g, b)" with integers or percentages and
+// the SVG color keywords, in any case. The result is 0xrrggbb.
+bool parseColor(const QStringRef &value, uint *rgb);
+
+// the shortest of "#rgb", "#rrggbb" and a color keyword
+QString colorText(uint rgb);
+
+// Appends the shortest form of a color value to the buffer, which is left
+// unchanged if the value is not a plain color, e.g. "none" or "url(#a)".
+bool shortenColor(const QStringRef &value, QString *buffer);
+
+#endif
@@ -1,3 +1,4 @@
-HEADERS += svgminifier.h qcssparser_p.h
-SOURCES = main.cpp svgminifier.cpp qcssscanner.cpp qcssparser.cpp
+HEADERS += svgminifier.h qcssparser_p.h compression.h tarminifier.h options.h stdiobatch.h documentindex.h cssminifier.h svgstyle.h svgproperties.h numberformat.h pathdata.h numericvalue.h transform.h svgcolor.h shapes.h groupcollapser.h references.h whitespace.h pngrecompressor.h streampass.h eventstream.h
+SOURCES = main.cpp svgminifier.cpp qcssscanner.cpp qcssparser.cpp compression.cpp tarminifier.cpp options.cpp stdiobatch.cpp documentindex.cpp cssminifier.cpp svgstyle.cpp svgproperties.cpp numberformat.cpp pathdata.cpp numericvalue.cpp transform.cpp svgcolor.cpp shapes.cpp groupcollapser.cpp references.cpp whitespace.cpp pngrecompressor.cpp streampass.cpp eventstream.cpp
 QT = core
+LIBS += -lz
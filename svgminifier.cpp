@@ -25,13 +25,40 @@
 #include "svgminifier.h"
 
 #include <QtCore/QIODevice>
+#include <QtCore/QBuffer>
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QFile>
+#include <QtCore/QHash>
+#include <QtCore/QMap>
+#include <QtCore/QMutex>
+#include <QtCore/QRunnable>
+#include <QtCore/QSet>
+#include <QtCore/QSharedPointer>
 #include <QtCore/QStack>
 #include <QtCore/QStringList>
+#include <QtCore/QThreadPool>
+#include <QtCore/QWaitCondition>
 #include <QtCore/QXmlStreamReader>
 #include <QtCore/QXmlStreamWriter>
 
+#include "cssminifier.h"
+#include "compression.h"
+#include "documentindex.h"
+#include "eventstream.h"
+#include "groupcollapser.h"
+#include "numberformat.h"
+#include "numericvalue.h"
+#include "pathdata.h"
+#include "pngrecompressor.h"
+#include "shapes.h"
+#include "streampass.h"
+#include "svgcolor.h"
 #include "qcssparser_p.h"
+#include "references.h"
+#include "svgproperties.h"
+#include "svgstyle.h"
+#include "transform.h"
+#include "whitespace.h"
 
 class SvgMinifier::Private
 {
@@ -42,9 +69,35 @@ public:
     bool simplifyStyle;
     bool keepMetadata;
     bool keepEditorData;
+    bool minifyStyleSheets;
+    bool removeUnusedStyleRules;
+    bool styleToClass;
+    bool gzipCostModel;
+    bool optimizePaths;
+    bool flattenTransforms;
+    bool removeDefaults;
+    bool convertShapes;
+    bool collapseGroups;
+    bool reuseSubtrees;
+    bool mergeDefinitions;
+    bool removeUnusedDefinitions;
+    bool removeUnusedNamespaces;
+    bool removeHidden;
+    bool collapseWhitespace;
+    bool recompressImages;
+    int precision;
+    QIODevice *eventDevice;
+    AutoTune autoTune;
+    int timeBudget;
     QStringList editorNamespaces;
-    QStringList editorPrefixes;
     QStringList excludedId;
+    QList<SvgMinifier> variants;
+
+    bool needsIndex() const;
+    bool sharesIndex(const Private &other) const;
+    DocumentIndex *scan(const QByteArray &document, const EventStream *events) const;
+
+    class Writer;
 };
 
 SvgMinifier::SvgMinifier()
@@ -58,6 +111,26 @@ SvgMinifier::SvgMinifier()
     d->simplifyStyle = true;
     d->keepMetadata = true;
     d->keepEditorData = false;
+    d->minifyStyleSheets = true;
+    d->removeUnusedStyleRules = false;
+    d->styleToClass = false;
+    d->gzipCostModel = false;
+    d->optimizePaths = true;
+    d->flattenTransforms = false;
+    d->removeDefaults = true;
+    d->convertShapes = false;
+    d->collapseGroups = true;
+    d->reuseSubtrees = false;
+    d->mergeDefinitions = false;
+    d->removeUnusedDefinitions = false;
+    d->removeUnusedNamespaces = false;
+    d->removeHidden = false;
+    d->collapseWhitespace = true;
+    d->recompressImages = false;
+    d->eventDevice = 0;
+    d->autoTune = NoAutoTune;
+    d->timeBudget = 1000;
+    d->precision = -1;
 
     d->editorNamespaces << "http://www.inkscape.org/namespaces/inkscape";
     d->editorNamespaces << "http://sodipodi.sourceforge.net/DTD/sodipodi-0.dtd";
@@ -81,11 +154,23 @@ SvgMinifier::SvgMinifier()
     d->excludedId << "text";
 }
 
+SvgMinifier::SvgMinifier(const SvgMinifier &other)
+{
+    d = new Private(*other.d);
+}
+
 SvgMinifier::~SvgMinifier()
 {
     delete d;
 }
 
+SvgMinifier &SvgMinifier::operator=(const SvgMinifier &other)
+{
+    if (this != &other)
+        *d = *other.d;
+    return *this;
+}
+
 void SvgMinifier::setInputDevice(QIODevice *device)
 {
     d->inputDevice = device;
@@ -116,6 +201,111 @@ void SvgMinifier::setKeepEditorData(bool keep)
     d->keepEditorData = keep;
 }
 
+void SvgMinifier::setMinifyStyleSheets(bool minify)
+{
+    d->minifyStyleSheets = minify;
+}
+
+void SvgMinifier::setRemoveUnusedStyleRules(bool remove)
+{
+    d->removeUnusedStyleRules = remove;
+}
+
+void SvgMinifier::setStyleToClass(bool enable)
+{
+    d->styleToClass = enable;
+}
+
+void SvgMinifier::setGzipCostModel(bool enable)
+{
+    d->gzipCostModel = enable;
+}
+
+void SvgMinifier::setOptimizePaths(bool optimize)
+{
+    d->optimizePaths = optimize;
+}
+
+void SvgMinifier::setFlattenTransforms(bool flatten)
+{
+    d->flattenTransforms = flatten;
+}
+
+void SvgMinifier::setRemoveDefaults(bool remove)
+{
+    d->removeDefaults = remove;
+}
+
+void SvgMinifier::setConvertShapes(bool convert)
+{
+    d->convertShapes = convert;
+}
+
+void SvgMinifier::setCollapseGroups(bool collapse)
+{
+    d->collapseGroups = collapse;
+}
+
+void SvgMinifier::setReuseSubtrees(bool reuse)
+{
+    d->reuseSubtrees = reuse;
+}
+
+void SvgMinifier::setMergeDefinitions(bool merge)
+{
+    d->mergeDefinitions = merge;
+}
+
+void SvgMinifier::setRemoveUnusedDefinitions(bool remove)
+{
+    d->removeUnusedDefinitions = remove;
+}
+
+void SvgMinifier::setRemoveUnusedNamespaces(bool remove)
+{
+    d->removeUnusedNamespaces = remove;
+}
+
+void SvgMinifier::setRemoveHidden(bool remove)
+{
+    d->removeHidden = remove;
+}
+
+void SvgMinifier::setCollapseWhitespace(bool collapse)
+{
+    d->collapseWhitespace = collapse;
+}
+
+void SvgMinifier::setRecompressImages(bool recompress)
+{
+    d->recompressImages = recompress;
+}
+
+void SvgMinifier::setPrecision(int decimals)
+{
+    d->precision = decimals;
+}
+
+void SvgMinifier::setAutoTune(AutoTune mode)
+{
+    d->autoTune = mode;
+}
+
+void SvgMinifier::setTimeBudget(int milliseconds)
+{
+    d->timeBudget = milliseconds;
+}
+
+void SvgMinifier::setEventStreamDevice(QIODevice *device)
+{
+    d->eventDevice = device;
+}
+
+void SvgMinifier::addVariant(const SvgMinifier &variant)
+{
+    d->variants += variant;
+}
+
 void SvgMinifier::removeId(const QString &id)
 {
     if (!d->excludedId.contains(id))
@@ -139,81 +329,590 @@ static bool listContains(const QStringList &list, const QStringRef &str)
 }
 
 
-static QXmlStreamAttributes parseStyle(const QStringRef &styleRef)
+// convenient function to remove an attribute given the name
+static QXmlStreamAttributes attrRemoved(const QXmlStreamAttributes &attributes,
+                                        const QString &name)
 {
-    QXmlStreamAttributes attributes;
-    QCss::Parser parser;
+    QXmlStreamAttributes result;
+    result.reserve(qMax(1, attributes.count() - 1));
 
-    parser.init(styleRef.toString());
-    QString key;
+    foreach (const QXmlStreamAttribute &attr, attributes)
+        if (attr.name() != name)
+            result += attr;
 
-    while (parser.hasNext()) {
-        parser.skipSpace();
+    return result;
+}
 
-        if (!parser.hasNext())
-            break;
-        parser.next();
+// the attributes with references to merged definitions replaced
+static QXmlStreamAttributes referencesRemapped(const QXmlStreamAttributes &attributes,
+                                              const QHash<QString, QString> &ids)
+{
+    QXmlStreamAttributes result;
+    result.reserve(attributes.count());
 
-        QString name = parser.lexem();
+    QString value;
+    foreach (const QXmlStreamAttribute &attr, attributes) {
+        if (remapReferences(attr.value(), isHref(attr.qualifiedName()), ids, &value))
+            result.append(attr.qualifiedName().toString(), value);
+        else
+            result += attr;
+    }
 
-        parser.skipSpace();
-        if (!parser.test(QCss::COLON))
-            break;
+    return result;
+}
+
+static bool hasDeclaration(const QXmlStreamAttributes &declarations, const QStringRef &name)
+{
+    foreach (const QXmlStreamAttribute &declaration, declarations)
+        if (declaration.name() == name)
+            return true;
+    return false;
+}
+
+// appends the shortest form of a numeric or color value to the buffer
+static bool shortenValue(const SvgProperty *property, const QStringRef &value, int precision,
+                         QString *buffer)
+{
+    if (property->flags & SvgProperty::NumericValue)
+        return shortenNumericValue(value, property->flags, precision, buffer);
+    if (property->flags & SvgProperty::Color)
+        return shortenColor(value, buffer);
+    return false;
+}
+
+// the declarations with their numbers and colors shortened
+static QXmlStreamAttributes shortenedValues(const QXmlStreamAttributes &declarations, int precision)
+{
+    QXmlStreamAttributes result;
+    result.reserve(declarations.count());
+    QString buffer;
+    foreach (const QXmlStreamAttribute &declaration, declarations) {
+        const SvgProperty *property = findProperty(declaration.name());
+        buffer.clear();
+        if (property && shortenValue(property, declaration.value(), precision, &buffer))
+            result.append(declaration.name().toString(), buffer);
+        else
+            result += declaration;
+    }
+    return result;
+}
+
+// take the normalized declarations of the "style" attribute and either
+// merge them with the other XML attributes or keep them as "style",
+// whichever is shorter. A declaration has to stay in "style" if it is not
+// a presentation attribute, is !important or is also set by a style sheet
+// rule, since presentation attributes lose against any style sheet.
+static QXmlStreamAttributes mergedStyle(const QXmlStreamAttributes &attributes,
+                                        const QXmlStreamAttributes &normalized,
+                                        const QSet<QString> &styleSheetProperties,
+                                        int precision)
+{
+    const QXmlStreamAttributes declarations = shortenedValues(normalized, precision);
 
-        parser.skipSpace();
-        if (!parser.hasNext())
+    // the inline style overrides attributes of the same name anyway
+    QXmlStreamAttributes result;
+    result.reserve(attributes.count() + declarations.count());
+    foreach (const QXmlStreamAttribute &attr, attributes)
+        if (attr.qualifiedName() != "style" && !hasDeclaration(declarations, attr.qualifiedName()))
+            result += attr;
+
+    if (declarations.isEmpty())
+        return result;
+
+    bool movable = true;
+    foreach (const QXmlStreamAttribute &declaration, declarations) {
+        if (!findProperty(declaration.name())
+            || styleSheetProperties.contains(declaration.name().toString())
+            || declaration.value().contains(QLatin1String("!important"))) {
+            movable = false;
             break;
+        }
+    }
+
+    // ' style="..."'
+    const QString style = styleText(declarations);
+    if (movable && attributesLength(declarations) <= style.size() + 9)
+        result += declarations;
+    else
+        result.append("style", style);
+
+    return result;
+}
+
+// adds a name to the "class" attribute
+static QXmlStreamAttributes classAdded(const QXmlStreamAttributes &attributes,
+                                       const QString &className)
+{
+    const QStringRef classNames = attributes.value("class");
+    if (classNames.isEmpty()) {
+        QXmlStreamAttributes result = attributes;
+        result.append("class", className);
+        return result;
+    }
+
+    QXmlStreamAttributes result = attrRemoved(attributes, "class");
+    result.append("class", classNames.toString() + QLatin1Char(' ') + className);
+    return result;
+}
+
+// "a", "b", ..., "Z", "aa", "ab", ...
+static QString shortName(int number)
+{
+    static const char letters[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    QString name;
+    do {
+        name.prepend(QLatin1Char(letters[number % 52]));
+        number = number / 52 - 1;
+    } while (number >= 0);
+    return name;
+}
+
+static QByteArray repeated(const QString &text, int count)
+{
+    const QByteArray data = text.toUtf8();
+    QByteArray result;
+    result.reserve(data.size() * count);
+    for (int i = 0; i < count; ++i)
+        result += data;
+    return result;
+}
+
+struct StyleUsage
+{
+    QString style;
+    int count;
+};
 
-        const int firstSymbol = parser.index;
-        int symbolCount = 0;
+static bool moreFrequent(const StyleUsage &a, const StyleUsage &b)
+{
+    if (a.count != b.count)
+        return a.count > b.count;
+    return a.style < b.style;
+}
+
+// Picks the "style" attribute values which are cheaper to write once as a
+// class rule than on every element, and gives each of them a class name.
+// The gzip cost model compares the deflated size of a sample instead, since
+// repetitions are almost free after compression.
+static QHash<QString, QString> assignStyleClasses(const DocumentIndex *index,
+                                                  bool convertStyle, bool gzipCost)
+{
+    QList<StyleUsage> usages;
+    QHash<QString, int>::const_iterator it;
+    for (it = index->styleCounts.constBegin(); it != index->styleCounts.constEnd(); ++it) {
+        if (it.value() < 2)
+            continue;
+        StyleUsage usage;
+        usage.style = it.key();
+        usage.count = it.value();
+        usages += usage;
+    }
+    qSort(usages.begin(), usages.end(), moreFrequent);
+
+    QHash<QString, QString> classes;
+    int number = 0;
+    foreach (const StyleUsage &usage, usages) {
+        QString className;
         do {
-            parser.next();
-            ++symbolCount;
-        } while (parser.hasNext() && !parser.test(QCss::SEMICOLON));
+            className = shortName(number++);
+        } while (index->classes.contains(className));
+
+        const QXmlStreamAttributes declarations = parseStyle(QStringRef(&usage.style));
+        // the shorter of the encodings mergedStyle() chooses from
+        QString fallback = " style=\"" + usage.style + "\"";
+        if (convertStyle && attributesLength(declarations) < fallback.size()) {
+            fallback.clear();
+            foreach (const QXmlStreamAttribute &declaration, declarations)
+                fallback += QLatin1Char(' ') + declaration.name().toString()
+                            + "=\"" + declaration.value().toString() + QLatin1Char('"');
+        }
+        const QString reference = " class=\"" + className + QLatin1Char('"');
+        const QString rule = QLatin1Char('.') + className + QLatin1Char('{') + usage.style + QLatin1Char('}');
+
+        bool pays;
+        if (gzipCost) {
+            // a sample is enough, the cost grows linearly with the count
+            const int sample = qMin(usage.count, 64);
+            const qint64 before = deflatedSize(repeated(fallback, sample));
+            const qint64 after = deflatedSize(repeated(reference, sample));
+            pays = after * usage.count / sample + deflatedSize(rule.toUtf8())
+                   < before * usage.count / sample;
+        } else {
+            pays = usage.count * reference.size() + rule.size() < usage.count * fallback.size();
+        }
 
-        QString value;
-        for (int i = firstSymbol; i < firstSymbol + symbolCount; ++i)
-            value += parser.symbols.at(i).lexem();
+        if (pays)
+            classes.insert(usage.style, className);
+        else
+            --number;
+    }
+
+    return classes;
+}
+
+// whether the value depends on the one of the parent, like "1.2em", "80%",
+// "larger" or "bolder", so that the same text may compute to another value
+static bool isRelativeValue(const QString &value)
+{
+    static const char *const keywords[] = { "larger", "smaller", "bolder", "lighter" };
+    for (int i = 0; i < 4; ++i)
+        if (value == QLatin1String(keywords[i]))
+            return true;
+    return value.endsWith(QLatin1Char('%')) || value.endsWith(QLatin1String("em"))
+        || value.endsWith(QLatin1String("ex"));
+}
 
-        parser.skipSpace();
+// the computed value of an inherited property as far as it is known, a null
+// string if it is not
+static QString computedValue(const QString &value, const QString &parentValue)
+{
+    if (value == QLatin1String("inherit"))
+        return parentValue;
+    if (isRelativeValue(value))
+        return QString();
+    return value;
+}
 
-        attributes.append(name, value);
+// Whether an element gets the value of a presentation attribute anyway:
+// the initial value of a property which is not inherited, or the value of
+// the parent for an inherited one. The latter needs to be sure that no
+// style sheet gives the parent another value.
+static bool redundantValue(const SvgProperty *property, const QString &value,
+                           const QString &parentValue, bool parentKnown)
+{
+    if (!(property->flags & SvgProperty::Inherited)) {
+        if (!property->initial)
+            return false;
+        // "black" is written "#000"
+        const QString initial = QLatin1String(property->initial);
+        uint rgb;
+        uint initialRgb;
+        if ((property->flags & SvgProperty::Color) && parseColor(QStringRef(&value), &rgb)
+            && parseColor(QStringRef(&initial), &initialRgb))
+            return rgb == initialRgb;
+        return value == initial;
     }
+    if (value == QLatin1String("inherit"))
+        return true;
+    return parentKnown && !parentValue.isNull() && value == parentValue && !isRelativeValue(value);
+}
 
-    return attributes;
+// sets the computed values of the inherited properties in the declarations
+static void applyDeclarations(QVector<QString> *computed, const QXmlStreamAttributes &declarations,
+                              const QVector<QString> &parentStyle)
+{
+    foreach (const QXmlStreamAttribute &declaration, declarations) {
+        const SvgProperty *property = findProperty(declaration.name());
+        if (!property) {
+            // "font" and "marker" set several properties, which are not
+            // worth parsing out of the shorthand
+            if (declaration.name() == QLatin1String("font") || declaration.name() == QLatin1String("marker"))
+                for (int i = 0; i < propertyCount(); ++i) {
+                    const char *shorthand = shorthandOf(propertyAt(i));
+                    if (shorthand && declaration.name() == QLatin1String(shorthand))
+                        (*computed)[i] = QString();
+                }
+            continue;
+        }
+        if (!(property->flags & SvgProperty::Inherited))
+            continue;
+        const int i = propertyIndex(property);
+        const QString value = declaration.value().toString().trimmed();
+        if (value.contains(QLatin1String("!important")))
+            (*computed)[i] = QString();
+        else
+            (*computed)[i] = computedValue(value, parentStyle.at(i));
+    }
 }
 
-// convenient function to remove an attribute given the name
-static QXmlStreamAttributes attrRemoved(const QXmlStreamAttributes &attributes,
-                                        const QString &name)
+// Replaces the geometry of a shape by path data if a path is shorter. Type
+// selectors and animations of the geometry would not apply any longer, so
+// this is only for documents without style sheets and for elements without
+// children.
+static bool convertedToPath(const QStringRef &tag, QXmlStreamAttributes *attributes, int precision)
 {
+    QString path;
+    if (!shapePathData(tag, *attributes, precision, &path))
+        return false;
+
     QXmlStreamAttributes result;
-    result.reserve(qMax(1, attributes.count() - 1));
+    QString buffer;
+    int shapeLength = tag.size();
+    foreach (const QXmlStreamAttribute &a, *attributes) {
+        if (!isShapeGeometry(tag, a.qualifiedName())) {
+            result += a;
+            continue;
+        }
+        // ' name="value"', as it would be written
+        const SvgProperty *property = findAttribute(a.name());
+        buffer.clear();
+        if (property && shortenValue(property, a.value(), precision, &buffer))
+            shapeLength += a.qualifiedName().size() + buffer.size() + 4;
+        else
+            shapeLength += a.qualifiedName().size() + a.value().size() + 4;
+    }
 
-    foreach (const QXmlStreamAttribute &attr, attributes)
-        if (attr.name() != name)
-            result += attr;
+    // 'path d="..."'
+    if (path.size() + 9 >= shapeLength)
+        return false;
 
-    return result;
+    result.append("d", path);
+    *attributes = result;
+    return true;
 }
 
-// take the value of the "style" attribute, parse it and then
-// merged the result with other XML attributes
-static QXmlStreamAttributes mergedStyle(const QXmlStreamAttributes &attributes)
+// the value of a presentation attribute, the declarations of the "style"
+// attribute win
+static QString propertyValue(const QXmlStreamAttributes &attributes,
+                             const QXmlStreamAttributes &style, const QString &name)
 {
-    if (!attributes.hasAttribute("style"))
-        return attributes;
+    QString value = attributes.value(name).toString();
+    foreach (const QXmlStreamAttribute &declaration, style)
+        if (declaration.name() == name)
+            value = declaration.value().toString();
+    return value;
+}
 
-    QXmlStreamAttributes result = attrRemoved(attributes, "style");
+static bool usesPaintServer(const QXmlStreamAttributes &attributes, const QXmlStreamAttributes &style)
+{
+    return propertyValue(attributes, style, "fill").contains(QLatin1String("url("))
+        || propertyValue(attributes, style, "stroke").contains(QLatin1String("url("));
+}
 
-    QXmlStreamAttributes styles = parseStyle(attributes.value("style"));
-    foreach (const QXmlStreamAttribute &attr, styles)
-        if (!attributes.hasAttribute(attr.value().toString()))
-            result += attr;
+// whether the element is clipped, masked or filtered, which all may depend
+// on its user space
+static bool usesUserSpace(const QXmlStreamAttributes &attributes, const QXmlStreamAttributes &style)
+{
+    static const char *const names[] = { "clip-path", "mask", "filter" };
+    for (int i = 0; i < 3; ++i) {
+        const QString value = propertyValue(attributes, style, QLatin1String(names[i])).trimmed();
+        if (!value.isEmpty() && value != QLatin1String("none"))
+            return true;
+    }
+    return false;
+}
+
+static bool isZero(const QXmlStreamAttributes &attributes, const char *name)
+{
+    double value;
+    return parseNumber(attributes.value(QLatin1String(name)), &value) && value == 0;
+}
+
+// whether a rendered element is sure to show nothing, whatever its content;
+// display does not apply to gradients and other resources, and a clip path
+// ignores the opacity of its content
+static bool rendersNothing(const QStringRef &tag, const QXmlStreamAttributes &attributes,
+                           const QXmlStreamAttributes &style, bool inClipPath)
+{
+    static const char *const rendered[] = {
+        "a", "circle", "ellipse", "g", "image", "line", "path", "polygon",
+        "polyline", "rect", "switch", "text", "use"
+    };
+    bool isRendered = false;
+    for (unsigned i = 0; i < sizeof(rendered) / sizeof(rendered[0]); ++i)
+        isRendered = isRendered || tag == QLatin1String(rendered[i]);
+    if (!isRendered)
+        return false;
 
+    if (propertyValue(attributes, style, "display").trimmed() == QLatin1String("none"))
+        return true;
+    double opacity;
+    const QString opacityValue = propertyValue(attributes, style, "opacity").trimmed();
+    if (!inClipPath && parseNumber(QStringRef(&opacityValue), &opacity) && opacity <= 0)
+        return true;
+
+    if (tag == "rect")
+        return isZero(attributes, "width") || isZero(attributes, "height");
+    if (tag == "circle")
+        return isZero(attributes, "r");
+    if (tag == "ellipse")
+        return isZero(attributes, "rx") || isZero(attributes, "ry");
+    if (tag == "path")
+        return attributes.value("d").toString().trimmed().isEmpty();
+    if (tag == "polygon" || tag == "polyline")
+        return attributes.value("points").toString().trimmed().isEmpty();
+    return false;
+}
+
+// whether the element or one of its descendants has one of the flags
+static bool subtreeHasFlags(const DocumentIndex *index, int number, int flags)
+{
+    const int last = number + index->elements.at(number).descendantCount;
+    for (int i = number; i <= last; ++i)
+        if (index->elements.at(i).flags & flags)
+            return true;
+    return false;
+}
+
+// whether the element is sure to have no markers, with the declarations of
+// the style attribute as read, which may have become a class by now
+static bool withoutMarkers(const QXmlStreamAttributes &attributes, const QXmlStreamAttributes &style,
+                           const QVector<QString> &parentStyle)
+{
+    static const char *const names[] = { "marker-start", "marker-mid", "marker-end" };
+    for (int i = 0; i < 3; ++i) {
+        const QString name = QLatin1String(names[i]);
+        QString value = propertyValue(attributes, style, name).trimmed();
+        // a null string, i.e. unknown, below a "marker" shorthand
+        if (value.isEmpty())
+            value = parentStyle.at(propertyIndex(findProperty(name)));
+        if (value != QLatin1String("none"))
+            return false;
+    }
+    // the shorthand, which is only valid in "style"
+    const QString marker = propertyValue(attributes, style, "marker").trimmed();
+    return marker.isEmpty() || marker == QLatin1String("none");
+}
+
+// Combines the transform inherited from the parent with the own one and
+// then moves it into the only child (for a group), into the coordinates
+// (for a translated shape or path) or writes it back. Returns the new
+// attributes.
+static QXmlStreamAttributes flattenedTransform(const QStringRef &tag,
+                                               const QXmlStreamAttributes &attributes,
+                                               const QXmlStreamAttributes &style,
+                                               const Transform &inherited,
+                                               const DocumentIndex *index, int elementNumber,
+                                               bool paintServer, bool optimizePaths,
+                                               int precision, Transform *pushed)
+{
+    // an animation may change the transform or the coordinates, from
+    // inside the element or through a reference to it
+    const DocumentIndex::Element &element = index->elements.at(elementNumber);
+    const bool animated = (element.flags & DocumentIndex::Element::Referenced)
+        || subtreeHasFlags(index, elementNumber, DocumentIndex::Element::Animation);
+
+    Transform transform = inherited;
+    Transform own;
+    if (animated || (attributes.hasAttribute("transform")
+                     && !parseTransform(attributes.value("transform"), &own))) {
+        if (inherited.isIdentity())
+            return attributes;
+        // kept as it is, so simply put the inherited one in front
+        QXmlStreamAttributes result = attrRemoved(attributes, "transform");
+        QString text = transformText(inherited, precision);
+        if (attributes.hasAttribute("transform"))
+            text += QLatin1Char(' ') + attributes.value("transform").toString();
+        result.append("transform", text);
+        return result;
+    }
+    transform = transform * own;
+
+    QXmlStreamAttributes result = attrRemoved(attributes, "transform");
+    if (transform.isIdentity())
+        return result;
+
+    if (tag == "g" && element.childCount == 1 && !usesUserSpace(result, style)) {
+        // a child with an id may be used elsewhere, without this group
+        const DocumentIndex::Element &child = index->elements.at(elementNumber + 1);
+        if ((child.flags & DocumentIndex::Element::Transformable)
+            && !(child.flags & DocumentIndex::Element::HasId)) {
+            *pushed = transform;
+            return result;
+        }
+    }
+
+    if (transform.isTranslation() && !paintServer && !usesUserSpace(result, style)) {
+        if (tag == "path" && optimizePaths) {
+            bool ok;
+            const QString path = optimizePathData(result.value("d"), precision,
+                                                  transform.e, transform.f, &ok);
+            if (ok) {
+                result = attrRemoved(result, "d");
+                result.append("d", path);
+                return result;
+            }
+        } else if (translateShape(tag, &result, transform.e, transform.f)) {
+            return result;
+        }
+    }
+
+    result.append("transform", transformText(transform, precision));
     return result;
 }
 
+// whether the value is a long base64 data URI, such as an embedded image,
+// with nothing which would need escaping
+static bool isLargeDataUri(const QStringRef &value)
+{
+    if (value.size() < 4096 || !value.startsWith(QLatin1String("data:")))
+        return false;
+    bool base64 = false;
+    const QChar *unicode = value.unicode();
+    for (int i = 0; i < value.size(); ++i) {
+        const ushort c = unicode[i].unicode();
+        if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9'))
+            continue;
+        if (c == '+' || c == '/' || c == '=' || c == ' ' || c == ':' || c == '-' || c == '.')
+            continue;
+        if (c == ',' && i >= 7 && !base64) {
+            // the comma which ends ";base64"
+            base64 = true;
+            for (int j = 0; j < 7; ++j)
+                base64 = base64 && unicode[i - 7 + j].unicode() == uchar(";base64"[j]);
+            continue;
+        }
+        if (c == ';' || c == ',')
+            continue;
+        return false;
+    }
+    return base64;
+}
+
+// an embedded PNG image with its data deflated again, if that is smaller
+static bool recompressedImage(const QStringRef &value, QString *result)
+{
+    static const QString prefix = QLatin1String("data:image/png;base64,");
+    if (!value.startsWith(prefix))
+        return false;
+    const QByteArray png = QByteArray::fromBase64(value.toLatin1().mid(prefix.size()));
+    const QByteArray recompressed = recompressedPng(png);
+    if (recompressed.isEmpty())
+        return false;
+    const QByteArray encoded = recompressed.toBase64();
+    if (prefix.size() + encoded.size() >= value.size())
+        return false;
+    *result = prefix + QString::fromLatin1(encoded.constData(), encoded.size());
+    return true;
+}
+
+// how the text content of an element is written
+enum TextMode {
+    DropWhitespace,
+    CollapseWhitespace,
+    PreserveWhitespace
+};
+
+// text is rendered only in text content elements, other XML vocabularies
+// and style sheets or scripts are left as they are
+template <typename Reader>
+static TextMode textMode(const Reader *xml, TextMode parent)
+{
+    static const char *const textElements[] = {
+        "altGlyph", "desc", "text", "textPath", "title", "tref", "tspan"
+    };
+    static const char *const verbatim[] = {
+        "foreignObject", "metadata", "script", "style"
+    };
+
+    if (parent == PreserveWhitespace)
+        return parent;
+    if (xml->attributes().value("xml:space") == QLatin1String("preserve"))
+        return PreserveWhitespace;
+    const QStringRef name = xml->qualifiedName();
+    if (!xml->prefix().isEmpty())
+        return PreserveWhitespace;
+    for (unsigned i = 0; i < sizeof(verbatim) / sizeof(verbatim[0]); ++i)
+        if (name == QLatin1String(verbatim[i]))
+            return PreserveWhitespace;
+    if (parent == CollapseWhitespace)
+        return parent;
+    for (unsigned i = 0; i < sizeof(textElements) / sizeof(textElements[0]); ++i)
+        if (name == QLatin1String(textElements[i]))
+            return CollapseWhitespace;
+    return DropWhitespace;
+}
+
 static bool isDrawingNode(const QStringRef &str)
 {
     if (str == QLatin1String("linearGradient"))
@@ -235,113 +934,990 @@ static bool isDrawingNode(const QStringRef &str)
     return false;
 }
 
-void SvgMinifier::run()
+// a <use> element in place of a repetition of an earlier subtree, with the
+// transform which its parent has pushed into it
+static void writeReference(GroupCollapser *output, const DocumentIndex *index,
+                           const DocumentIndex::Reference &reference,
+                           const Transform &inherited, int precision)
 {
-    // fall back to standard input
-    QFile standardInput;
-    if (!d->inputDevice) {
-        standardInput.open(stdin, QFile::ReadOnly);
-        d->inputDevice = &standardInput;
+    output->writeStartElement("use");
+    output->writeAttribute(index->xlinkPrefix + ":href", QLatin1Char('#') + reference.id);
+    const QString transform = transformText(inherited, precision);
+    if (!transform.isEmpty())
+        output->writeAttribute("transform", transform);
+    QString number;
+    if (roundNumber(reference.dx, precision) != 0) {
+        appendNumber(&number, reference.dx, precision);
+        output->writeAttribute("x", number);
+    }
+    if (roundNumber(reference.dy, precision) != 0) {
+        number.clear();
+        appendNumber(&number, reference.dy, precision);
+        output->writeAttribute("y", number);
     }
+    output->writeEndElement();
+}
 
-    // fall back to standard output
-    QFile standardOutput;
-    if (!d->outputDevice) {
-        standardOutput.open(stdout, QFile::WriteOnly);
-        d->outputDevice = &standardOutput;
+// Removes the elements and attributes in the namespaces of editors, with
+// the prefixes the root element declares for them.
+class EditorDataPass : public StreamPass
+{
+public:
+    EditorDataPass(const QStringList &namespaces) : namespaces(namespaces) {}
+
+    void process(StreamEvent *event);
+
+private:
+    QStringList namespaces;
+    QStringList prefixes;
+};
+
+void EditorDataPass::process(StreamEvent *event)
+{
+    if (event->type != StreamEvent::StartElement)
+        return;
+
+    if (event->name == "svg")
+        foreach (const QXmlStreamAttribute &a, *event->attributes)
+            if (namespaces.contains(a.value().toString()))
+                if (a.prefix() == "xmlns")
+                    prefixes += a.name().toString();
+
+    if (prefixes.isEmpty())
+        return;
+
+    if (prefixes.contains(event->prefix.toString())) {
+        event->dropped = true;
+        return;
     }
 
-    QXmlStreamReader *xml = new QXmlStreamReader(d->inputDevice);
-    xml->setNamespaceProcessing(false);
-    QXmlStreamWriter *out = new QXmlStreamWriter(d->outputDevice);
-    out->setAutoFormatting(true);
+    // the declarations of the prefixes go as well
+    QXmlStreamAttributes result;
+    result.reserve(event->attributes->count());
+    foreach (const QXmlStreamAttribute &a, *event->attributes)
+        if (!prefixes.contains(a.prefix().toString()) && !prefixes.contains(a.name().toString()))
+            result += a;
+    *event->attributes = result;
+}
 
-    bool skip;
+class MetadataPass : public StreamPass
+{
+public:
+    void process(StreamEvent *event)
+    {
+        if (event->type == StreamEvent::StartElement && event->name == "metadata")
+            event->dropped = true;
+    }
+};
+
+// Removes the ids of drawing elements which match the excluded prefixes,
+// unless a style sheet selects the element by it.
+class IdPass : public StreamPass
+{
+public:
+    IdPass(const QStringList &excluded, const DocumentIndex *index)
+        : excluded(excluded), index(index) {}
+
+    void process(StreamEvent *event);
+
+private:
+    QStringList excluded;
+    const DocumentIndex *index;
+};
+
+void IdPass::process(StreamEvent *event)
+{
+    if (event->type != StreamEvent::StartElement || !isDrawingNode(event->qualifiedName))
+        return;
+    const QStringRef id = event->attributes->value("id");
+    if (!listContains(excluded, id))
+        return;
+    if (index && index->styleSheetIds.contains(id.toString()))
+        return;
+
+    QXmlStreamAttributes result;
+    result.reserve(event->attributes->count() - 1);
+    foreach (const QXmlStreamAttribute &a, *event->attributes)
+        if (a.qualifiedName() != "id")
+            result += a;
+    *event->attributes = result;
+}
+
+// The "style" attribute of the element just read, parsed once for all the
+// writers fed by the same reader. A writer whose passes or remapped
+// references changed the attribute gets a parse of its own text.
+class ElementStyle
+{
+public:
+    ElementStyle() : normalizedDone(false), textDone(false) {}
+
+    void read(const QStringRef &style)
+    {
+        source = style.toString();
+        parsed = source.isEmpty() ? QXmlStreamAttributes() : parseStyle(QStringRef(&source));
+        normalizedDone = false;
+        textDone = false;
+    }
+
+    // the declarations as read, which keep applying to the element however
+    // a writer splits them between attributes, "style" and a class
+    const QXmlStreamAttributes &declarations() const { return parsed; }
+
+    QXmlStreamAttributes declarations(const QStringRef &style) const
+    {
+        return style == source ? parsed : parseStyle(style);
+    }
+
+    QXmlStreamAttributes normalized(const QStringRef &style)
+    {
+        if (style != source)
+            return normalizedStyle(parseStyle(style));
+        normalize();
+        return normalizedDeclarations;
+    }
+
+    QString normalizedText(const QStringRef &style)
+    {
+        if (style != source)
+            return styleText(normalizedStyle(parseStyle(style)));
+        if (!textDone) {
+            normalize();
+            text = styleText(normalizedDeclarations);
+            textDone = true;
+        }
+        return text;
+    }
+
+private:
+    void normalize()
+    {
+        if (!normalizedDone) {
+            normalizedDeclarations = normalizedStyle(parsed);
+            normalizedDone = true;
+        }
+    }
+
+    QString source;
+    QXmlStreamAttributes parsed;
+    bool normalizedDone;
+    QXmlStreamAttributes normalizedDeclarations;
+    bool textDone;
+    QString text;
+};
+
+// Turns style properties into attributes, knowing which properties the
+// style sheets so far set through the set of the writer.
+class StyleToXmlPass : public StreamPass
+{
+public:
+    StyleToXmlPass(const QSet<QString> *styleSheetProperties, ElementStyle *style, int precision)
+        : styleSheetProperties(styleSheetProperties), style(style), precision(precision) {}
+
+    void process(StreamEvent *event)
+    {
+        if (event->type == StreamEvent::StartElement && event->attributes->hasAttribute("style"))
+            *event->attributes = mergedStyle(*event->attributes,
+                                             style->normalized(event->attributes->value("style")),
+                                             *styleSheetProperties, precision);
+    }
+
+private:
+    const QSet<QString> *styleSheetProperties;
+    ElementStyle *style;
+    int precision;
+};
+
+// One configuration writing the document. Several of them can be fed the
+// tokens of the same reader, which is how variants share a parse.
+class SvgMinifier::Private::Writer
+{
+public:
+    Writer(Private *d, DocumentIndex *index, const QHash<QString, QString> &styleClasses,
+           ElementStyle *style, QIODevice *device);
+    ~Writer();
+
+    // for a QXmlStreamReader or an EventStreamReader
+    template <typename Reader> void process(const Reader *xml);
+    void finish();
+
+private:
+    // hands a token to the passes, returns false if one of them drops it
+    template <typename Reader> bool passed(StreamEvent::Type type, const Reader *xml);
+
+    Private *d;
+    DocumentIndex *index;
+    QHash<QString, QString> styleClasses;
+    ElementStyle *style;
+    PassChain passes;
+
+    QXmlStreamWriter *out;
+    GroupCollapser output;
+
+    bool collapseGroups;
+    QStack<bool> switchElements;
+    bool removeHidden;
+    QStack<bool> clipPaths;
+    QStack<TextMode> textModes;
     QStack<bool> skipElement;
-    skipElement.push(false);
 
     QXmlStreamAttributes attr;
+    QSet<QString> styleSheetProperties;
+    bool inStyleSheet;
+    bool styleSheetCDATA;
+    QString styleSheet;
+
+    // reused for every rewritten numeric or color value
+    QString numbers;
+
+    bool flattenTransforms;
+    int elementNumber;
+    Transform inherited;
+    Transform pushedTransform;
+    QStack<bool> paintServers;
+
+    QVector<QString> computed;
+    QVector<QString> parentStyle;
+    QStack<QVector<QString> > computedStyles;
+    QXmlStreamAttributes classStyle;
+};
 
-    while (!xml->atEnd()) {
-        switch (xml->readNext()) {
+SvgMinifier::Private::Writer::Writer(Private *d, DocumentIndex *index,
+                                     const QHash<QString, QString> &styleClasses,
+                                     ElementStyle *style, QIODevice *device)
+    : d(d)
+    , index(index)
+    , styleClasses(styleClasses)
+    , style(style)
+    , out(new QXmlStreamWriter(device))
+    , output(out)
+{
+    // the indentation would take the place of the whitespace removed
+    out->setAutoFormatting(!d->collapseWhitespace);
 
-        case QXmlStreamReader::StartDocument:
-            out->writeStartDocument(xml->documentVersion().toString(),
-                                    xml->isStandaloneDocument());
-            break;
+    // the content of a <switch> and elements matched by a style sheet
+    // selector depend on the structure, without a pre-scan it is only
+    // known which style sheets came before
+    collapseGroups = d->collapseGroups && !(index && index->hasStyleSheet);
+    switchElements.push(false);
 
-        case QXmlStreamReader::EndDocument:
-            out->writeEndDocument();
-            break;
+    // hidden elements are removed, with the pre-scan to know which are
+    // referenced, unless style sheet rules could show them
+    removeHidden = d->removeHidden && !index->hasStyleSheet;
+    clipPaths.push(false);
+
+    textModes.push(d->collapseWhitespace ? DropWhitespace : PreserveWhitespace);
+    skipElement.push(false);
+
+    // properties set by style sheet rules, without a pre-scan only those of
+    // the style sheets seen so far are known
+    if (index)
+        styleSheetProperties = index->styleSheetProperties;
+
+    // content of the current <style> element
+    inStyleSheet = false;
+    styleSheetCDATA = false;
+
+    // transforms are moved into an only child or into the coordinates,
+    // with the element numbers of the pre-scan to find the child
+    flattenTransforms = d->flattenTransforms;
+    elementNumber = -1;
+
+    // whether an element or one of its ancestors paints with a gradient or
+    // pattern, which may be in user space
+    paintServers.push(false);
+
+    // the computed values of the inherited properties, a null string where
+    // unknown, implicitly shared until an element sets one of them
+    computed = QVector<QString>(propertyCount());
+    for (int i = 0; i < propertyCount(); ++i) {
+        const SvgProperty *property = propertyAt(i);
+        if (!(property->flags & SvgProperty::Inherited) || !property->initial)
+            continue;
+        // as the value would be written, "#000" for "black"
+        const QString initial = QLatin1String(property->initial);
+        QString value;
+        computed[i] = shortenValue(property, QStringRef(&initial), -1, &value) ? value : initial;
+    }
+    computedStyles.push(computed);
+
+    // the stages which only look at one element at a time, in this order
+    if (!d->keepEditorData)
+        passes.append(new EditorDataPass(d->editorNamespaces));
+    if (!d->keepMetadata)
+        passes.append(new MetadataPass);
+    if (!d->excludedId.isEmpty())
+        passes.append(new IdPass(d->excludedId, index));
+    if (d->convertStyle)
+        passes.append(new StyleToXmlPass(&styleSheetProperties, style, d->precision));
+}
+
+SvgMinifier::Private::Writer::~Writer()
+{
+    delete out;
+}
+
+template <typename Reader>
+bool SvgMinifier::Private::Writer::passed(StreamEvent::Type type, const Reader *xml)
+{
+    if (passes.isEmpty())
+        return true;
+
+    StreamEvent event;
+    event.type = type;
+    event.attributes = type == StreamEvent::StartElement ? &attr : 0;
+    if (type == StreamEvent::ProcessingInstruction) {
+        event.qualifiedName = xml->processingInstructionTarget();
+        event.name = event.qualifiedName;
+        event.text = xml->processingInstructionData();
+    } else {
+        event.qualifiedName = xml->qualifiedName();
+        event.prefix = xml->prefix();
+        event.name = xml->name();
+        event.text = xml->text();
+    }
+    passes.process(&event);
+    return !event.dropped;
+}
+
+template <typename Reader>
+void SvgMinifier::Private::Writer::process(const Reader *xml)
+{
+    bool skip;
+    bool paintServer;
+
+    switch (xml->tokenType()) {
+
+    case QXmlStreamReader::StartDocument:
+        out->writeStartDocument(xml->documentVersion().toString(),
+                                xml->isStandaloneDocument());
+        break;
+
+    case QXmlStreamReader::EndDocument:
+        out->writeEndDocument();
+        break;
+
+    case QXmlStreamReader::StartElement:
+        ++elementNumber;
+        inherited = pushedTransform;
+        pushedTransform = Transform();
+        paintServer = true;
+        computed = computedStyles.top();
+        if (skipElement.top()) {
+            skipElement.push(true);
+            switchElements.push(false);
+            clipPaths.push(false);
+            textModes.push(PreserveWhitespace);
+        } else {
+            attr = xml->attributes();
+
+            if (index && !index->mergedIds.isEmpty())
+                attr = referencesRemapped(attr, index->mergedIds);
+
+            classStyle.clear();
+            if (!styleClasses.isEmpty() && attr.hasAttribute("style")) {
+                const QString className = styleClasses.value(style->normalizedText(attr.value("style")));
+                if (!className.isEmpty()) {
+                    classStyle = style->normalized(attr.value("style"));
+                    attr = classAdded(attrRemoved(attr, "style"), className);
+                }
+            }
+
+            skip = !passed(StreamEvent::StartElement, xml);
+
+            // only the first of equal definitions is written, and only
+            // those which are used
+            if (!skip && index)
+                skip = index->elements.at(elementNumber).flags
+                    & (DocumentIndex::Element::Merged | DocumentIndex::Element::Unused);
+
+            // a repeated subtree is written as a <use> element at once
+            if (!skip && index && !index->references.isEmpty()) {
+                QHash<int, DocumentIndex::Reference>::const_iterator reference
+                    = index->references.constFind(elementNumber);
+                if (reference != index->references.constEnd()) {
+                    writeReference(&output, index, reference.value(), inherited, d->precision);
+                    skip = true;
+                }
+            }
 
-        case QXmlStreamReader::StartElement:
-            if (skipElement.top()) {
-                skipElement.push(true);
-            } else {
-                attr = xml->attributes();
-
-                if (xml->name() == "svg" && !d->keepEditorData)
-                    foreach (const QXmlStreamAttribute &a, attr)
-                        if (d->editorNamespaces.contains(a.value().toString()))
-                            if (a.prefix() == "xmlns")
-                                d->editorPrefixes += a.name().toString();
-
-                if (d->editorPrefixes.count())
-                    foreach (QString ns, d->editorPrefixes)
-                        attr = attrRemoved(attr, ns);
-
-                skip = d->editorPrefixes.contains(xml->prefix().toString());
-                if (!skip && !d->keepMetadata)
-                    skip = xml->name() == "metadata";
-
-                skipElement.push(skip);
-                if (!skip) {
-                    const QStringRef &tag = xml->qualifiedName();
-                    out->writeStartElement(tag.toString());
-                    if (d->convertStyle)
-                        attr = mergedStyle(attr);
-                    foreach (const QXmlStreamAttribute &a, attr) {
-                        if (d->editorPrefixes.contains(a.prefix().toString()))
+            // the choice of a <switch> depends on all of its children,
+            // the style attribute may have become a class by now
+            if (!skip && removeHidden && !switchElements.top()
+                && rendersNothing(xml->qualifiedName(), xml->attributes(), style->declarations(),
+                                  clipPaths.top()))
+                skip = !subtreeHasFlags(index, elementNumber,
+                                        DocumentIndex::Element::Referenced
+                                        | DocumentIndex::Element::Animation
+                                        | DocumentIndex::Element::Reused);
+
+            skipElement.push(skip);
+            if (!skip) {
+                const QStringRef &tag = xml->qualifiedName();
+                const bool reused = index && (index->elements.at(elementNumber).flags & DocumentIndex::Element::Reused);
+                if (reused)
+                    attr.append("id", index->generatedIds.value(elementNumber));
+                if (tag == "style") {
+                    collapseGroups = false;
+                    output.flush();
+                    const QStringRef type = attr.value("type");
+                    inStyleSheet = type.isEmpty() || type == "text/css";
+                    styleSheetCDATA = false;
+                    styleSheet.clear();
+                }
+                // a style sheet rule could refer to the user space as well
+                if (flattenTransforms && !index->hasStyleSheet) {
+                    paintServer = paintServers.top() || usesPaintServer(attr, style->declarations());
+                    attr = flattenedTransform(tag, attr, style->declarations(), inherited, index, elementNumber,
+                                              paintServer, d->optimizePaths, d->precision,
+                                              &pushedTransform);
+                }
+
+                // an element with an id may be used elsewhere and then
+                // inherits from the <use> element, which can not be the
+                // root element
+                const bool root = skipElement.count() == 2;
+                if (!root && attr.hasAttribute("id"))
+                    computed = QVector<QString>(propertyCount());
+                parentStyle = computed;
+
+                // a rect would show markers as a path, lines and
+                // polygons show them anyway
+                bool converted = false;
+                if (d->convertShapes && !index->hasStyleSheet
+                    && index->elements.at(elementNumber).childCount == 0
+                    && (tag != "rect" || withoutMarkers(attr, style->declarations(), parentStyle)))
+                    converted = convertedToPath(tag, &attr, d->precision);
+
+                output.writeStartElement(converted ? QString("path") : tag.toString(),
+                                         collapseGroups && tag == "g" && !switchElements.top());
+
+                foreach (const QXmlStreamAttribute &a, attr) {
+                    if (d->removeUnusedNamespaces && a.prefix() == "xmlns" && !index->isPrefixUsed(a.name()))
+                        continue;
+                    QString image;
+                    if (d->recompressImages && isHref(a.qualifiedName()) && recompressedImage(a.value(), &image)) {
+                        if (isLargeDataUri(QStringRef(&image)))
+                            output.writeRawAttribute(a.qualifiedName().toString(), QStringRef(&image));
+                        else
+                            output.writeAttribute(a.qualifiedName().toString(), image);
+                        continue;
+                    }
+                    if (isHref(a.qualifiedName()) && isLargeDataUri(a.value())) {
+                        output.writeRawAttribute(a.qualifiedName().toString(), a.value());
+                        continue;
+                    }
+                    if (d->optimizePaths && tag == "path" && a.qualifiedName() == "d") {
+                        output.writeAttribute("d", optimizePathData(a.value(), d->precision));
+                        continue;
+                    }
+                    const SvgProperty *property = a.prefix().isEmpty() ? findAttribute(a.name()) : 0;
+                    bool shortened = false;
+                    if (property) {
+                        numbers.clear();
+                        shortened = shortenValue(property, a.value(), d->precision, &numbers);
+                        // an identity transform is dropped
+                        if (shortened && numbers.isEmpty() && (property->flags & SvgProperty::TransformList))
+                            continue;
+                    }
+                    const int propertyNumber = property ? propertyIndex(property) : -1;
+                    if (propertyNumber >= 0) {
+                        const QString value = shortened ? numbers : a.value().toString();
+                        // with a pre-scan it is known which properties
+                        // style sheets could change for the parent
+                        const char *shorthand = shorthandOf(property);
+                        const bool parentKnown = root
+                            || (index && !index->styleSheetProperties.contains(a.name().toString())
+                                && !(shorthand && index->styleSheetProperties.contains(QLatin1String(shorthand))));
+                        const bool redundant = d->removeDefaults
+                            && redundantValue(property, value, parentStyle.at(propertyNumber), parentKnown);
+                        if (property->flags & SvgProperty::Inherited)
+                            computed[propertyNumber] = computedValue(value, parentStyle.at(propertyNumber));
+                        if (redundant)
                             continue;
-                        if (a.qualifiedName() == "id" && isDrawingNode(tag))
-                            if (listContains(d->excludedId, a.value()))
-                                continue;
-                        out->writeAttribute(a);
                     }
+                    if (shortened)
+                        output.writeAttribute(a.name().toString(), numbers);
+                    else
+                        output.writeAttribute(a.qualifiedName().toString(), a.value().toString());
+                }
+
+                // for the href of the <use> elements in place of repetitions
+                if (root && index && index->declareXlinkPrefix)
+                    output.writeAttribute(QLatin1String("xmlns:") + index->xlinkPrefix,
+                                          QLatin1String("http://www.w3.org/1999/xlink"));
+
+                // class rules and then the style attribute override the
+                // presentation attributes
+                if (!classStyle.isEmpty())
+                    applyDeclarations(&computed, classStyle, parentStyle);
+                if (attr.hasAttribute("style"))
+                    applyDeclarations(&computed, style->declarations(attr.value("style")), parentStyle);
+
+                // the shared style rules go first into the root element
+                if (!styleClasses.isEmpty() && skipElement.count() == 2) {
+                    QMap<QString, QString> rules;
+                    QHash<QString, QString>::const_iterator it;
+                    for (it = styleClasses.constBegin(); it != styleClasses.constEnd(); ++it)
+                        rules.insert(it.value(), it.key());
+                    QString css;
+                    QMap<QString, QString>::const_iterator rule;
+                    for (rule = rules.constBegin(); rule != rules.constEnd(); ++rule)
+                        css += QLatin1Char('.') + rule.key() + QLatin1Char('{') + rule.value() + QLatin1Char('}');
+                    output.writeStartElement("style");
+                    output.writeCharacters(css);
+                    output.writeEndElement();
                 }
             }
-            break;
+            switchElements.push(!skip && xml->qualifiedName() == "switch");
+            clipPaths.push(clipPaths.top() || xml->qualifiedName() == "clipPath");
+            textModes.push(textMode(xml, textModes.top()));
+        }
+        paintServers.push(paintServer);
+        computedStyles.push(computed);
+        break;
+
+    case QXmlStreamReader::EndElement:
+        skip = skipElement.pop();
+        paintServers.pop();
+        computedStyles.pop();
+        switchElements.pop();
+        clipPaths.pop();
+        textModes.pop();
+        if (inStyleSheet && !skip) {
+            collectStyleSheetProperties(styleSheet, &styleSheetProperties);
+            // a script could add the classes and ids at run time
+            const DocumentIndex *usage = d->removeUnusedStyleRules && !index->hasScript ? index : 0;
+            const QString css = d->minifyStyleSheets ? minifyStyleSheet(styleSheet, usage) : styleSheet;
+            if (styleSheetCDATA)
+                output.writeCDATA(css);
+            else
+                output.writeCharacters(css);
+            inStyleSheet = false;
+        }
+        if (!skip) {
+            passed(StreamEvent::EndElement, xml);
+            output.writeEndElement();
+        }
+        break;
+
+    case QXmlStreamReader::Characters:
+        if (inStyleSheet && !skipElement.top()) {
+            styleSheet += xml->text();
+            styleSheetCDATA = styleSheetCDATA || xml->isCDATA();
+        } else if (!skipElement.top() && passed(StreamEvent::Characters, xml)) {
+            if (xml->isCDATA())
+                output.writeCDATA(xml->text().toString());
+            else if (textModes.top() == CollapseWhitespace)
+                output.writeCharacters(collapsedWhitespace(xml->text()));
+            else if (textModes.top() == PreserveWhitespace || !xml->isWhitespace())
+                output.writeCharacters(xml->text().toString());
+        }
+        break;
 
-        case QXmlStreamReader::EndElement:
-            skip = skipElement.pop();
-            if (!skip)
-                out->writeEndElement();
-            break;
+    case QXmlStreamReader::ProcessingInstruction:
+        if (passed(StreamEvent::ProcessingInstruction, xml))
+            output.writeProcessingInstruction(xml->processingInstructionTarget().toString(),
+                                              xml->processingInstructionData().toString());
+        break;
 
-        case QXmlStreamReader::Characters:
-            if (!skipElement.top()) {
-                if (xml->isCDATA())
-                    out->writeCDATA(xml->text().toString());
-                else
-                    out->writeCharacters(xml->text().toString());
-            }
-            break;
+    default:
+        break;
+    }
+}
 
-        case QXmlStreamReader::ProcessingInstruction:
-            out->writeProcessingInstruction(xml->processingInstructionTarget().toString(),
-                                            xml->processingInstructionData().toString());
-            break;
+void SvgMinifier::Private::Writer::finish()
+{
+    // a document cut off inside a group
+    output.flush();
+}
 
-        default:
-            break;
+bool SvgMinifier::Private::needsIndex() const
+{
+    return removeUnusedStyleRules || styleToClass || flattenTransforms || convertShapes
+        || reuseSubtrees || mergeDefinitions || removeUnusedDefinitions
+        || removeUnusedNamespaces || removeHidden;
+}
+
+bool SvgMinifier::Private::sharesIndex(const Private &other) const
+{
+    return needsIndex() == other.needsIndex()
+        && reuseSubtrees == other.reuseSubtrees
+        && mergeDefinitions == other.mergeDefinitions
+        && removeUnusedDefinitions == other.removeUnusedDefinitions
+        && removeUnusedNamespaces == other.removeUnusedNamespaces
+        && (removeHidden || flattenTransforms) == (other.removeHidden || other.flattenTransforms)
+        && keepEditorData == other.keepEditorData
+        && (keepEditorData || editorNamespaces == other.editorNamespaces)
+        && keepMetadata == other.keepMetadata;
+}
+
+DocumentIndex *SvgMinifier::Private::scan(const QByteArray &document,
+                                          const EventStream *events) const
+{
+    DocumentIndex *index = new DocumentIndex;
+    index->findRepeatedSubtrees = reuseSubtrees;
+    index->mergeDefinitions = mergeDefinitions;
+    index->findUnusedDefinitions = removeUnusedDefinitions;
+    index->findUsedPrefixes = removeUnusedNamespaces;
+    index->findReferencedElements = removeHidden || flattenTransforms;
+    if (!keepEditorData)
+        index->editorNamespaces = editorNamespaces;
+    index->removeMetadata = !keepMetadata;
+    if (events)
+        index->scan(events);
+    else
+        index->scan(document);
+    return index;
+}
+
+bool SvgMinifier::run()
+{
+    QIODevice *inputDevice = d->inputDevice;
+    QIODevice *outputDevice = d->outputDevice;
+
+    // fall back to standard input
+    QFile standardInput;
+    if (!inputDevice) {
+        standardInput.open(stdin, QFile::ReadOnly);
+        inputDevice = &standardInput;
+    }
+
+    // fall back to standard output
+    QFile standardOutput;
+    if (!outputDevice) {
+        standardOutput.open(stdout, QFile::WriteOnly);
+        outputDevice = &standardOutput;
+    }
+
+    if (d->autoTune != NoAutoTune) {
+        const bool ok = autoTuned(inputDevice, outputDevice);
+        if (standardInput.isOpen())
+            standardInput.close();
+        if (standardOutput.isOpen())
+            standardOutput.close();
+        return ok;
+    }
+
+    QList<Private *> configurations;
+    configurations << d;
+    for (int i = 0; i < d->variants.count(); ++i)
+        if (d->variants.at(i).d->outputDevice)
+            configurations << d->variants[i].d;
+
+    // stages which need to know the whole document get a pre-scan
+    bool needsIndex = false;
+    foreach (const Private *configuration, configurations)
+        needsIndex = needsIndex || configuration->needsIndex();
+
+    // a recorded event stream takes the place of the XML parser
+    const bool replay = EventStream::isEventStream(inputDevice->peek(8));
+    EventStream events;
+    QByteArray document;
+    QXmlStreamReader *xml = 0;
+    if (replay) {
+        document = inputDevice->readAll();
+        events.load(document);
+    } else if (needsIndex) {
+        document = inputDevice->readAll();
+        xml = new QXmlStreamReader(document);
+    } else {
+        xml = new QXmlStreamReader(inputDevice);
+    }
+    if (xml)
+        xml->setNamespaceProcessing(false);
+
+    // variants share the pre-scan and the style classes with an earlier
+    // configuration which asks for the same
+    QList<DocumentIndex *> indexes;
+    QList<DocumentIndex *> scanned;
+    QList<QHash<QString, QString> > classes;
+    QList<Private::Writer *> writers;
+    ElementStyle style;
+    for (int i = 0; i < configurations.count(); ++i) {
+        Private *configuration = configurations.at(i);
+        int shared = 0;
+        while (shared < i && !configuration->sharesIndex(*configurations.at(shared)))
+            ++shared;
+
+        DocumentIndex *index = 0;
+        if (shared < i) {
+            index = indexes.at(shared);
+        } else if (configuration->needsIndex()) {
+            index = configuration->scan(document, replay ? &events : 0);
+            scanned << index;
+        }
+        indexes << index;
+
+        // only without other style sheets, a class rule could lose against
+        // one of their rules where the inline style used to win
+        QHash<QString, QString> styleClasses;
+        if (configuration->styleToClass && !index->hasStyleSheet) {
+            const Private *other = shared < i ? configurations.at(shared) : 0;
+            if (other && other->styleToClass && other->convertStyle == configuration->convertStyle
+                && other->gzipCostModel == configuration->gzipCostModel)
+                styleClasses = classes.at(shared);
+            else
+                styleClasses = assignStyleClasses(index, configuration->convertStyle,
+                                                  configuration->gzipCostModel);
         }
+        classes << styleClasses;
+
+        writers << new Private::Writer(configuration, index, styleClasses, &style,
+                                       i ? configuration->outputDevice : outputDevice);
     }
 
+    bool ok;
+    if (replay) {
+        EventStreamReader reader(&events);
+        while (!reader.atEnd()) {
+            reader.readNext();
+            if (reader.tokenType() == QXmlStreamReader::StartElement)
+                style.read(reader.attributes().value("style"));
+            foreach (Private::Writer *writer, writers)
+                writer->process(&reader);
+        }
+        ok = !reader.hasError();
+
+        // recorded already
+        if (d->eventDevice)
+            d->eventDevice->write(document);
+    } else {
+        EventStreamWriter recorder;
+        while (!xml->atEnd()) {
+            xml->readNext();
+            if (d->eventDevice)
+                recorder.record(xml);
+            if (xml->tokenType() == QXmlStreamReader::StartElement)
+                style.read(xml->attributes().value("style"));
+            foreach (Private::Writer *writer, writers)
+                writer->process(xml);
+        }
+        ok = !xml->hasError();
+
+        if (d->eventDevice)
+            d->eventDevice->write(recorder.data());
+    }
+
+    foreach (Private::Writer *writer, writers)
+        writer->finish();
+    qDeleteAll(writers);
+    qDeleteAll(scanned);
+    delete xml;
+
     if (standardInput.isOpen())
         standardInput.close();
 
     if (standardOutput.isOpen())
         standardOutput.close();
+
+    return ok;
+}
+
+
+QByteArray SvgMinifier::minify(const QByteArray &data, bool *ok)
+{
+    QIODevice *inputDevice = d->inputDevice;
+    QIODevice *outputDevice = d->outputDevice;
+
+    QBuffer input;
+    input.setData(data);
+    input.open(QIODevice::ReadOnly);
+
+    QByteArray result;
+    QBuffer output(&result);
+    output.open(QIODevice::WriteOnly);
+
+    d->inputDevice = &input;
+    d->outputDevice = &output;
+    const bool success = run();
+    d->inputDevice = inputDevice;
+    d->outputDevice = outputDevice;
+
+    if (ok)
+        *ok = success;
+    return result;
+}
+
+// a result of auto-tuning, with the deflated size as the measure of the
+// compressed one, which is only worked out when it is compared
+struct TuneCandidate
+{
+    TuneCandidate() : compressedSize(-1) {}
+
+    int deflated()
+    {
+        if (compressedSize < 0)
+            compressedSize = deflatedSize(output);
+        return compressedSize;
+    }
+
+    QByteArray output;
+    int compressedSize;
+};
+
+static bool isSmaller(TuneCandidate *candidate, TuneCandidate *other, bool compressed)
+{
+    if (compressed && candidate->deflated() != other->deflated())
+        return candidate->deflated() < other->deflated();
+    if (candidate->output.size() != other->output.size())
+        return candidate->output.size() < other->output.size();
+    return candidate->deflated() < other->deflated();
+}
+
+// shared by the jobs of one document, which may still be running once the
+// time budget of the document is spent
+struct TuneResults
+{
+    TuneResults() : compressed(false), expired(false), pending(0) {}
+
+    QByteArray events;
+    bool compressed;
+    QMutex mutex;
+    QWaitCondition finished;
+    bool expired;
+    int pending;
+    QList<TuneCandidate> candidates;
+};
+
+// only for the candidates, which would otherwise queue up behind the
+// documents that a tar archive or a batch run keeps in the global pool
+Q_GLOBAL_STATIC(QThreadPool, tunePool)
+
+class TuneJob : public QRunnable
+{
+public:
+    TuneJob(const SvgMinifier &minifier, const QSharedPointer<TuneResults> &results)
+        : minifier(minifier), results(results) {}
+
+    void run();
+
+private:
+    SvgMinifier minifier;
+    QSharedPointer<TuneResults> results;
+};
+
+void TuneJob::run()
+{
+    bool expired;
+    {
+        QMutexLocker lock(&results->mutex);
+        expired = results->expired;
+    }
+
+    TuneCandidate candidate;
+    bool ok = false;
+    if (!expired)
+        candidate.output = minifier.minify(results->events, &ok);
+
+    // deflated on the pool while there is time, to be compared by size
+    if (ok && results->compressed) {
+        {
+            QMutexLocker lock(&results->mutex);
+            expired = results->expired;
+        }
+        if (!expired)
+            candidate.deflated();
+    }
+
+    QMutexLocker lock(&results->mutex);
+    if (ok && !results->expired)
+        results->candidates += candidate;
+    --results->pending;
+    results->finished.wakeAll();
 }
 
+bool SvgMinifier::autoTuned(QIODevice *inputDevice, QIODevice *outputDevice)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    // the candidates share the tokenized document
+    QSharedPointer<TuneResults> results(new TuneResults);
+    results->compressed = d->autoTune == TuneCompressedSize;
+    results->events = inputDevice->readAll();
+    if (!EventStream::isEventStream(results->events))
+        results->events = EventStreamWriter::recorded(results->events);
+
+    SvgMinifier configuration(*this);
+    configuration.d->autoTune = NoAutoTune;
+    configuration.d->eventDevice = 0;
+    configuration.d->variants.clear();
+
+    // each combination of style attributes or properties and no classes,
+    // classes by size or by compressed size, apart from the configured one;
+    // the number of decimals and the removed ids change the document, they
+    // stay as they are set
+    QList<SvgMinifier> waiting;
+    static const int combinations = 6;
+    for (int i = 0; i < combinations; ++i) {
+        const bool convertStyle = (i & 1) != 0;
+        const bool styleToClass = i >= 2;
+        const bool gzipCostModel = i >= 4;
+        if (convertStyle == d->convertStyle && styleToClass == d->styleToClass
+            && (!styleToClass || gzipCostModel == d->gzipCostModel))
+            continue;
+
+        SvgMinifier candidate(configuration);
+        candidate.setConvertStyle(convertStyle);
+        candidate.setStyleToClass(styleToClass);
+        candidate.setGzipCostModel(gzipCostModel);
+
+        // only what starts at once is pending, the rest is left for this
+        // thread as long as there is time
+        {
+            QMutexLocker lock(&results->mutex);
+            ++results->pending;
+        }
+        TuneJob *job = new TuneJob(candidate, results);
+        if (!tunePool()->tryStart(job)) {
+            delete job;
+            QMutexLocker lock(&results->mutex);
+            --results->pending;
+            waiting += candidate;
+        }
+    }
 
+    // on this thread, so that it is done even when the pool is busy
+    bool ok;
+    TuneCandidate best;
+    best.output = configuration.minify(results->events, &ok);
+    if (ok && results->compressed)
+        best.deflated();
+
+    // a combination is started here only if it is likely to be done in
+    // time, taking as long as the configured one did
+    const qint64 duration = timer.elapsed();
+    foreach (const SvgMinifier &candidate, waiting) {
+        if (timer.elapsed() + duration > d->timeBudget)
+            break;
+        {
+            QMutexLocker lock(&results->mutex);
+            ++results->pending;
+        }
+        TuneJob(candidate, results).run();
+    }
+
+    // the jobs still running finish in the background, their results are
+    // dropped
+    QList<TuneCandidate> candidates;
+    {
+        QMutexLocker lock(&results->mutex);
+        while (results->pending > 0) {
+            const qint64 remaining = qMax(Q_INT64_C(0), qint64(d->timeBudget) - timer.elapsed());
+            if (remaining == 0)
+                break;
+            results->finished.wait(&results->mutex, (unsigned long)remaining);
+        }
+        results->expired = true;
+        candidates = results->candidates;
+    }
+    if (ok)
+        for (int i = 0; i < candidates.count(); ++i)
+            if (isSmaller(&candidates[i], &best, results->compressed))
+                best = candidates.at(i);
+
+    outputDevice->write(best.output);
+    if (d->eventDevice)
+        d->eventDevice->write(results->events);
+    return ok;
+}
@@ -22,6 +22,9 @@
   THE SOFTWARE.
 */
 
+#ifndef SVGMINIFIER_H
+#define SVGMINIFIER_H
+
 #include <QIODevice>
 #include <QString>
 
@@ -30,22 +33,77 @@
 class SvgMinifier
 {
 public:
+    // what auto-tuning minimizes, see setAutoTune()
+    enum AutoTune {
+        NoAutoTune,
+        TuneSize,
+        TuneCompressedSize
+    };
+
     SvgMinifier();
+    SvgMinifier(const SvgMinifier &other);
     ~SvgMinifier();
 
+    SvgMinifier &operator=(const SvgMinifier &other);
+
     void setInputDevice(QIODevice *device);
     void setOutputDevice(QIODevice *device);
 
+    // records the tokens of the input to the device as an event stream,
+    // see eventstream.h, which run() takes as input in place of the XML
+    void setEventStreamDevice(QIODevice *device);
+
     void setConvertStyle(bool convert);
     void setSimplifyStyle(bool simplify);
     void setKeepMetadata(bool keep);
     void setKeepEditorData(bool keep);
+    void setMinifyStyleSheets(bool minify);
+    void setRemoveUnusedStyleRules(bool remove);
+    void setStyleToClass(bool enable);
+    void setGzipCostModel(bool enable);
+    void setOptimizePaths(bool optimize);
+    void setFlattenTransforms(bool flatten);
+    void setRemoveDefaults(bool remove);
+    void setConvertShapes(bool convert);
+    void setCollapseGroups(bool collapse);
+    void setReuseSubtrees(bool reuse);
+    void setMergeDefinitions(bool merge);
+    void setRemoveUnusedDefinitions(bool remove);
+    void setRemoveUnusedNamespaces(bool remove);
+    void setRemoveHidden(bool remove);
+    void setCollapseWhitespace(bool collapse);
+    void setRecompressImages(bool recompress);
+    void setPrecision(int decimals);
+
+    // Also minifies the document with every combination of the style
+    // options, on the thread pool, and writes the smallest result. The
+    // configuration as set always counts, the other combinations only if
+    // they are done within the time budget. Variants are not written.
+    // run() takes the budget or the configured minification, whichever
+    // is longer; a combination left for the calling thread only starts if
+    // it would be done in time, judging by the configured one. Those
+    // already running on the pool when the budget is spent finish in the
+    // background, each one full minification at most, and are dropped.
+    void setAutoTune(AutoTune mode);
+    void setTimeBudget(int milliseconds);
 
     void removeId(const QString &id);
     void keepId(const QString &id);
-    void run();
+
+    // also writes the document as the variant configures it to the output
+    // device of the variant, from the same parse and pre-scan
+    void addVariant(const SvgMinifier &variant);
+
+    bool run();
+
+    // convenience function which minifies an in-memory document
+    QByteArray minify(const QByteArray &data, bool *ok = 0);
 
 private:
+    bool autoTuned(QIODevice *inputDevice, QIODevice *outputDevice);
+
     class Private;
     Private *d;
 };
+
+#endif
@@ -0,0 +1,218 @@
+/*
+  SVGMin - Aggressive SVG minifier
+
+  Copyright (C) 2009 Ariya Hidayat (ariya.hidayat@gmail.com)
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include "svgproperties.h"
+
+#include <string.h>
+
+// SVG 1.1 presentation attributes plus paint-order and vector-effect from
+// SVG 2, sorted by name for the binary search. The initial value is left
+// out where it depends on the user agent, such as for "color", or where
+// its style sheet overrides it for some elements, as for "overflow".
+static const SvgProperty properties[] = {
+    { "alignment-baseline", 0, "auto" },
+    { "baseline-shift", SvgProperty::Number, "baseline" },
+    { "clip", 0, "auto" },
+    { "clip-path", 0, "none" },
+    { "clip-rule", SvgProperty::Inherited, "nonzero" },
+    { "color", SvgProperty::Inherited | SvgProperty::Color, 0 },
+    { "color-interpolation", SvgProperty::Inherited, "sRGB" },
+    { "color-interpolation-filters", SvgProperty::Inherited, "linearRGB" },
+    { "color-profile", SvgProperty::Inherited, "auto" },
+    { "color-rendering", SvgProperty::Inherited, "auto" },
+    { "cursor", SvgProperty::Inherited, "auto" },
+    { "direction", SvgProperty::Inherited, "ltr" },
+    { "display", 0, "inline" },
+    { "dominant-baseline", 0, "auto" },
+    { "enable-background", 0, "accumulate" },
+    { "fill", SvgProperty::Inherited | SvgProperty::Color, "black" },
+    { "fill-opacity", SvgProperty::Inherited | SvgProperty::Number, "1" },
+    { "fill-rule", SvgProperty::Inherited, "nonzero" },
+    { "filter", 0, "none" },
+    { "flood-color", SvgProperty::Color, "black" },
+    { "flood-opacity", SvgProperty::Number, "1" },
+    { "font-family", SvgProperty::Inherited, 0 },
+    { "font-size", SvgProperty::Inherited | SvgProperty::Number, "medium" },
+    { "font-size-adjust", SvgProperty::Inherited, "none" },
+    { "font-stretch", SvgProperty::Inherited, "normal" },
+    { "font-style", SvgProperty::Inherited, "normal" },
+    { "font-variant", SvgProperty::Inherited, "normal" },
+    { "font-weight", SvgProperty::Inherited, "normal" },
+    { "glyph-orientation-horizontal", SvgProperty::Inherited, "0deg" },
+    { "glyph-orientation-vertical", SvgProperty::Inherited, "auto" },
+    { "image-rendering", SvgProperty::Inherited, "auto" },
+    { "kerning", SvgProperty::Inherited | SvgProperty::Number, "auto" },
+    { "letter-spacing", SvgProperty::Inherited | SvgProperty::Number, "normal" },
+    { "lighting-color", SvgProperty::Color, "white" },
+    { "marker-end", SvgProperty::Inherited, "none" },
+    { "marker-mid", SvgProperty::Inherited, "none" },
+    { "marker-start", SvgProperty::Inherited, "none" },
+    { "mask", 0, "none" },
+    { "opacity", SvgProperty::Number, "1" },
+    { "overflow", 0, 0 },
+    { "paint-order", SvgProperty::Inherited, "normal" },
+    { "pointer-events", SvgProperty::Inherited, "visiblePainted" },
+    { "shape-rendering", SvgProperty::Inherited, "auto" },
+    { "stop-color", SvgProperty::Color, "black" },
+    { "stop-opacity", SvgProperty::Number, "1" },
+    { "stroke", SvgProperty::Inherited | SvgProperty::Color, "none" },
+    { "stroke-dasharray", SvgProperty::Inherited | SvgProperty::NumberList, "none" },
+    { "stroke-dashoffset", SvgProperty::Inherited | SvgProperty::Number, "0" },
+    { "stroke-linecap", SvgProperty::Inherited, "butt" },
+    { "stroke-linejoin", SvgProperty::Inherited, "miter" },
+    { "stroke-miterlimit", SvgProperty::Inherited | SvgProperty::Number, "4" },
+    { "stroke-opacity", SvgProperty::Inherited | SvgProperty::Number, "1" },
+    { "stroke-width", SvgProperty::Inherited | SvgProperty::Number, "1" },
+    { "text-anchor", SvgProperty::Inherited, "start" },
+    { "text-decoration", 0, "none" },
+    { "text-rendering", SvgProperty::Inherited, "auto" },
+    { "unicode-bidi", 0, "normal" },
+    { "vector-effect", 0, "none" },
+    { "visibility", SvgProperty::Inherited, "visible" },
+    { "word-spacing", SvgProperty::Inherited | SvgProperty::Number, "normal" },
+    { "writing-mode", SvgProperty::Inherited, "lr-tb" }
+};
+
+static const int propertyTableSize = sizeof(properties) / sizeof(properties[0]);
+
+// other attributes which hold numbers, sorted by name (in byte order, i.e.
+// case-sensitive) for the binary search
+static const SvgProperty attributes[] = {
+    { "baseFrequency", SvgProperty::NumberList, 0 },
+    { "cx", SvgProperty::Number, 0 },
+    { "cy", SvgProperty::Number, 0 },
+    { "dx", SvgProperty::NumberList, 0 },
+    { "dy", SvgProperty::NumberList, 0 },
+    { "fr", SvgProperty::Number, 0 },
+    { "fx", SvgProperty::Number, 0 },
+    { "fy", SvgProperty::Number, 0 },
+    { "gradientTransform", SvgProperty::TransformList, 0 },
+    { "height", SvgProperty::Number, 0 },
+    { "k1", SvgProperty::Number, 0 },
+    { "k2", SvgProperty::Number, 0 },
+    { "k3", SvgProperty::Number, 0 },
+    { "k4", SvgProperty::Number, 0 },
+    { "markerHeight", SvgProperty::Number, 0 },
+    { "markerWidth", SvgProperty::Number, 0 },
+    { "offset", SvgProperty::Number, 0 },
+    { "pathLength", SvgProperty::Number, 0 },
+    { "patternTransform", SvgProperty::TransformList, 0 },
+    { "points", SvgProperty::CoordinateList, 0 },
+    { "r", SvgProperty::Number, 0 },
+    { "refX", SvgProperty::Number, 0 },
+    { "refY", SvgProperty::Number, 0 },
+    { "rotate", SvgProperty::NumberList, 0 },
+    { "rx", SvgProperty::Number, 0 },
+    { "ry", SvgProperty::Number, 0 },
+    { "scale", SvgProperty::Number, 0 },
+    { "startOffset", SvgProperty::Number, 0 },
+    { "stdDeviation", SvgProperty::NumberList, 0 },
+    { "textLength", SvgProperty::Number, 0 },
+    { "transform", SvgProperty::TransformList, 0 },
+    { "viewBox", SvgProperty::NumberList, 0 },
+    { "width", SvgProperty::Number, 0 },
+    { "x", SvgProperty::NumberList, 0 },
+    { "x1", SvgProperty::Number, 0 },
+    { "x2", SvgProperty::Number, 0 },
+    { "y", SvgProperty::NumberList, 0 },
+    { "y1", SvgProperty::Number, 0 },
+    { "y2", SvgProperty::Number, 0 }
+};
+
+static const int attributeTableSize = sizeof(attributes) / sizeof(attributes[0]);
+
+// compares a property name with a Latin-1 string, without any allocation
+static int compareName(const QChar *name, int length, const char *other)
+{
+    for (int i = 0; i < length; ++i) {
+        const ushort c = name[i].unicode();
+        const uchar o = uchar(other[i]);
+        if (!o)
+            return 1;
+        if (c != o)
+            return c < o ? -1 : 1;
+    }
+    return other[length] ? -1 : 0;
+}
+
+static const SvgProperty *find(const SvgProperty *table, int count,
+                               const QChar *name, int length)
+{
+    int low = 0;
+    int high = count - 1;
+    while (low <= high) {
+        const int middle = (low + high) / 2;
+        const int comparison = compareName(name, length, table[middle].name);
+        if (comparison == 0)
+            return &table[middle];
+        if (comparison < 0)
+            high = middle - 1;
+        else
+            low = middle + 1;
+    }
+    return 0;
+}
+
+const SvgProperty *findProperty(const QStringRef &name)
+{
+    return find(properties, propertyTableSize, name.unicode(), name.size());
+}
+
+const SvgProperty *findProperty(const QString &name)
+{
+    return find(properties, propertyTableSize, name.unicode(), name.size());
+}
+
+const SvgProperty *findAttribute(const QStringRef &name)
+{
+    if (const SvgProperty *property = find(properties, propertyTableSize, name.unicode(), name.size()))
+        return property;
+    return find(attributes, attributeTableSize, name.unicode(), name.size());
+}
+
+int propertyCount()
+{
+    return propertyTableSize;
+}
+
+const SvgProperty *propertyAt(int index)
+{
+    return &properties[index];
+}
+
+int propertyIndex(const SvgProperty *property)
+{
+    if (property < properties || property >= properties + propertyTableSize)
+        return -1;
+    return int(property - properties);
+}
+
+const char *shorthandOf(const SvgProperty *property)
+{
+    if (strncmp(property->name, "font-", 5) == 0)
+        return "font";
+    if (strncmp(property->name, "marker-", 7) == 0)
+        return "marker";
+    return 0;
+}
@@ -0,0 +1,73 @@
+/*
+  SVGMin - Aggressive SVG minifier
+
+  Copyright (C) 2009 Ariya Hidayat (ariya.hidayat@gmail.com)
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#ifndef SVGPROPERTIES_H
+#define SVGPROPERTIES_H
+
+#include <QtCore/QString>
+
+// A property which may be written as a presentation attribute, or any
+// other attribute whose value type is known.
+struct SvgProperty
+{
+    enum Flag {
+        Inherited = 1,
+
+        // the value type, if it contains numbers
+        Number = 2,         // "1.5", "10px", "50%"
+        NumberList = 4,     // "0 0 100 100", "1,2 3,4"
+        TransformList = 8,  // "translate(10,20) scale(2)"
+        CoordinateList = 16, // "1,2 3,-4", written as compact as path data
+        NumericValue = Number | NumberList | TransformList | CoordinateList,
+        Color = 32          // "#f00", "rgb(255,0,0)", "red"
+    };
+
+    const char *name;
+    int flags;
+
+    // the initial value as written in the specification, 0 if unknown
+    const char *initial;
+};
+
+// Returns 0 if the name is not a presentation attribute, e.g. a CSS-only
+// property such as "line-height" or an editor extension.
+const SvgProperty *findProperty(const QStringRef &name);
+const SvgProperty *findProperty(const QString &name);
+
+// Looks up any attribute with a known value type: a presentation attribute
+// or a geometry attribute such as "x" or "viewBox".
+const SvgProperty *findAttribute(const QStringRef &name);
+
+// The presentation attributes are numbered from 0 to propertyCount() - 1,
+// e.g. for a table of computed values.
+int propertyCount();
+const SvgProperty *propertyAt(int index);
+int propertyIndex(const SvgProperty *property);
+
+// The CSS shorthand which sets the property as well, "font" for
+// "font-weight" and "marker" for "marker-end", or 0 if there is none.
+// The shorthands themselves are not presentation attributes.
+const char *shorthandOf(const SvgProperty *property);
+
+#endif
@@ -0,0 +1,111 @@
+/*
+  SVGMin - Aggressive SVG minifier
+
+  Copyright (C) 2009 Ariya Hidayat (ariya.hidayat@gmail.com)
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include "svgstyle.h"
+
+#include "qcssparser_p.h"
+
+QXmlStreamAttributes parseStyle(const QStringRef &styleRef)
+{
+    QXmlStreamAttributes attributes;
+    QCss::Parser parser;
+
+    parser.init(styleRef.toString());
+
+    while (parser.hasNext()) {
+        parser.skipSpace();
+
+        if (!parser.hasNext())
+            break;
+        parser.next();
+
+        QString name = parser.lexem();
+
+        parser.skipSpace();
+        if (!parser.test(QCss::COLON))
+            break;
+
+        parser.skipSpace();
+        if (!parser.hasNext())
+            break;
+
+        const int firstSymbol = parser.index;
+        int symbolCount = 0;
+        do {
+            parser.next();
+            ++symbolCount;
+        } while (parser.hasNext() && !parser.test(QCss::SEMICOLON));
+
+        QString value;
+        for (int i = firstSymbol; i < firstSymbol + symbolCount; ++i)
+            value += parser.symbols.at(i).lexem();
+
+        parser.skipSpace();
+
+        attributes.append(name, value);
+    }
+
+    return attributes;
+}
+
+QXmlStreamAttributes normalizedStyle(const QXmlStreamAttributes &declarations)
+{
+    QXmlStreamAttributes result;
+    result.reserve(declarations.count());
+
+    // later declarations override earlier ones, the order is kept since
+    // a shorthand like "font" interacts with its longhand properties
+    for (int i = 0; i < declarations.count(); ++i) {
+        const QStringRef name = declarations.at(i).name();
+        bool overridden = false;
+        for (int j = i + 1; j < declarations.count() && !overridden; ++j)
+            overridden = declarations.at(j).name() == name;
+        if (!overridden)
+            result.append(name.toString(), declarations.at(i).value().toString().trimmed());
+    }
+
+    return result;
+}
+
+QString styleText(const QXmlStreamAttributes &declarations)
+{
+    QString result;
+    foreach (const QXmlStreamAttribute &declaration, declarations) {
+        if (!result.isEmpty())
+            result += QLatin1Char(';');
+        result += declaration.name();
+        result += QLatin1Char(':');
+        result += declaration.value();
+    }
+    return result;
+}
+
+int attributesLength(const QXmlStreamAttributes &declarations)
+{
+    // ' name="value"'
+    int length = 0;
+    foreach (const QXmlStreamAttribute &declaration, declarations)
+        length += declaration.name().size() + declaration.value().size() + 4;
+    return length;
+}
@@ -0,0 +1,462 @@
+/*
+  SVGMin - Aggressive SVG minifier
+
+  Copyright (C) 2009 Ariya Hidayat (ariya.hidayat@gmail.com)
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include "tarminifier.h"
+
+#include <QtCore/QByteArray>
+#include <QtCore/QFile>
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <QtCore/QRunnable>
+#include <QtCore/QThread>
+#include <QtCore/QThreadPool>
+#include <QtCore/QWaitCondition>
+
+#include <stdio.h>
+#include <string.h>
+
+#include "compression.h"
+#include "svgminifier.h"
+
+// see POSIX.1-1988 (ustar) for the header layout
+static const int BlockSize = 512;
+static const int RecordSize = 20 * BlockSize;
+static const int NameOffset = 0;
+static const int NameLength = 100;
+static const int SizeOffset = 124;
+static const int SizeLength = 12;
+static const int ChecksumOffset = 148;
+static const int ChecksumLength = 8;
+static const int TypeOffset = 156;
+static const int MagicOffset = 257;
+static const int PrefixOffset = 345;
+static const int PrefixLength = 155;
+
+// members up to this size are held in memory, larger ones which are not
+// minified are copied through in pieces; larger documents and extended
+// headers are refused
+static const qint64 CopyThreshold = 1024 * 1024;
+static const qint64 MaximumMemberSize = 256 * 1024 * 1024;
+static const int CopyChunkSize = 64 * 1024;
+
+class MinifyJob : public QRunnable
+{
+public:
+    MinifyJob(const SvgMinifier &config, QMutex *mutex, QWaitCondition *finished);
+
+    void run();
+
+    SvgMinifier minifier;
+    QByteArray data;
+    bool compressed;
+    bool done;
+    bool ok;
+
+private:
+    QMutex *mutex;
+    QWaitCondition *finished;
+};
+
+MinifyJob::MinifyJob(const SvgMinifier &config, QMutex *m, QWaitCondition *f)
+    : minifier(config), compressed(false), done(false), ok(false), mutex(m), finished(f)
+{
+    setAutoDelete(false);
+}
+
+void MinifyJob::run()
+{
+    bool success = true;
+    QByteArray document = data;
+    if (compressed)
+        document = gzipUncompress(data, &success);
+    if (success)
+        document = minifier.minify(document, &success);
+    if (success && compressed) {
+        document = gzipCompress(document);
+        success = !document.isEmpty();
+    }
+
+    QMutexLocker lock(mutex);
+    if (success)
+        data = document;
+    ok = success;
+    done = true;
+    finished->wakeAll();
+}
+
+// an archive member, either copied verbatim or waiting for a minify job
+struct TarEntry
+{
+    TarEntry() : job(0) {}
+    QByteArray header;
+    QByteArray data;
+    MinifyJob *job;
+};
+
+class TarMinifier::Private
+{
+public:
+    Private(const SvgMinifier &config) : minifier(config), inputDevice(0), outputDevice(0) {}
+
+    bool readFully(char *buffer, qint64 size);
+    bool writeEntry(const TarEntry &entry);
+    bool copyEntry(const QByteArray &header, qint64 size);
+    void flush(int maxPendingJobs);
+
+    SvgMinifier minifier;
+    QIODevice *inputDevice;
+    QIODevice *outputDevice;
+    qint64 written;
+    bool ok;
+
+    QList<TarEntry> queue;
+    int pendingJobs;
+    QMutex mutex;
+    QWaitCondition finished;
+};
+
+TarMinifier::TarMinifier(const SvgMinifier &minifier)
+{
+    d = new Private(minifier);
+}
+
+TarMinifier::~TarMinifier()
+{
+    delete d;
+}
+
+void TarMinifier::setInputDevice(QIODevice *device)
+{
+    d->inputDevice = device;
+}
+
+void TarMinifier::setOutputDevice(QIODevice *device)
+{
+    d->outputDevice = device;
+}
+
+// pipes may deliver less than requested, so keep reading
+bool TarMinifier::Private::readFully(char *buffer, qint64 size)
+{
+    while (size > 0) {
+        const qint64 count = inputDevice->read(buffer, size);
+        if (count <= 0)
+            return false;
+        buffer += count;
+        size -= count;
+    }
+    return true;
+}
+
+static qint64 parseOctal(const char *field, int length)
+{
+    // GNU base-256 extension for sizes beyond 8 GiB
+    if (uchar(field[0]) & 0x80) {
+        qint64 value = uchar(field[0]) & 0x7f;
+        for (int i = 1; i < length; ++i)
+            value = (value << 8) | uchar(field[i]);
+        return value;
+    }
+
+    qint64 value = 0;
+    int i = 0;
+    while (i < length && (field[i] == ' ' || field[i] == '\0'))
+        ++i;
+    for (; i < length && field[i] >= '0' && field[i] <= '7'; ++i)
+        value = value * 8 + (field[i] - '0');
+    return value;
+}
+
+static qint64 paddedSize(qint64 size)
+{
+    return (size + BlockSize - 1) / BlockSize * BlockSize;
+}
+
+static void updateChecksum(QByteArray *header)
+{
+    char *h = header->data();
+    memset(h + ChecksumOffset, ' ', ChecksumLength);
+    unsigned int sum = 0;
+    for (int i = 0; i < BlockSize; ++i)
+        sum += uchar(h[i]);
+    char field[ChecksumLength + 1];
+    sprintf(field, "%06o", sum & 0777777);
+    memcpy(h + ChecksumOffset, field, 7);
+}
+
+// returns false if the size does not fit into the octal field
+static bool updateSize(QByteArray *header, qint64 size)
+{
+    if (size > Q_INT64_C(077777777777))
+        return false;
+    char field[SizeLength + 1];
+    sprintf(field, "%011llo", (unsigned long long)size);
+    memcpy(header->data() + SizeOffset, field, SizeLength);
+    updateChecksum(header);
+    return true;
+}
+
+static QByteArray headerField(const QByteArray &header, int offset, int length)
+{
+    const char *field = header.constData() + offset;
+    int size = 0;
+    while (size < length && field[size])
+        ++size;
+    return QByteArray(field, size);
+}
+
+// extracts the "path" record of a pax extended header
+static QByteArray paxRecord(const QByteArray &data, const char *key, bool *found)
+{
+    const QByteArray prefix = QByteArray(key) + '=';
+    int pos = 0;
+    *found = false;
+    while (pos < data.size()) {
+        const int space = data.indexOf(' ', pos);
+        if (space < 0)
+            break;
+        const int length = data.mid(pos, space - pos).toInt();
+        if (length <= 0 || pos + length > data.size())
+            break;
+        const QByteArray record = data.mid(space + 1, pos + length - space - 2);
+        if (record.startsWith(prefix)) {
+            *found = true;
+            return record.mid(prefix.size());
+        }
+        pos += length;
+    }
+    return QByteArray();
+}
+
+bool TarMinifier::Private::writeEntry(const TarEntry &entry)
+{
+    QByteArray header = entry.header;
+    QByteArray data = entry.data;
+
+    if (entry.job) {
+        if (entry.job->ok && updateSize(&header, entry.job->data.size()))
+            data = entry.job->data;
+        delete entry.job;
+        --pendingJobs;
+    }
+
+    if (outputDevice->write(header) != header.size())
+        return false;
+    if (outputDevice->write(data) != data.size())
+        return false;
+    const int padding = int(paddedSize(data.size()) - data.size());
+    if (padding && outputDevice->write(QByteArray(padding, '\0')) != padding)
+        return false;
+    written += header.size() + paddedSize(data.size());
+    return true;
+}
+
+// copies a member from the input to the output without holding it in
+// memory, the padding included
+bool TarMinifier::Private::copyEntry(const QByteArray &header, qint64 size)
+{
+    if (outputDevice->write(header) != header.size())
+        return false;
+    QByteArray buffer(CopyChunkSize, '\0');
+    for (qint64 remaining = paddedSize(size); remaining > 0; ) {
+        const qint64 count = qMin(remaining, qint64(CopyChunkSize));
+        if (!readFully(buffer.data(), count) || outputDevice->write(buffer.constData(), count) != count)
+            return false;
+        remaining -= count;
+    }
+    written += header.size() + paddedSize(size);
+    return true;
+}
+
+// writes out every entry at the front of the queue which is ready,
+// blocking on unfinished jobs while more than maxPendingJobs are queued
+void TarMinifier::Private::flush(int maxPendingJobs)
+{
+    while (!queue.isEmpty()) {
+        MinifyJob *job = queue.first().job;
+        if (job) {
+            QMutexLocker lock(&mutex);
+            while (!job->done) {
+                if (pendingJobs <= maxPendingJobs)
+                    return;
+                finished.wait(&mutex);
+            }
+        }
+        if (!writeEntry(queue.takeFirst()))
+            ok = false;
+    }
+}
+
+bool TarMinifier::run()
+{
+    // fall back to standard input
+    QFile standardInput;
+    if (!d->inputDevice) {
+        standardInput.open(stdin, QFile::ReadOnly);
+        d->inputDevice = &standardInput;
+    }
+
+    // fall back to standard output
+    QFile standardOutput;
+    if (!d->outputDevice) {
+        standardOutput.open(stdout, QFile::WriteOnly);
+        d->outputDevice = &standardOutput;
+    }
+
+    QThreadPool *pool = QThreadPool::globalInstance();
+    const int maxPendingJobs = 2 * qMax(1, pool->maxThreadCount());
+
+    d->written = 0;
+    d->ok = true;
+    d->pendingJobs = 0;
+
+    QByteArray longName;
+    QByteArray paxPath;
+    bool paxSize = false;
+    bool endOfArchive = false;
+
+    for (;;) {
+        QByteArray header(BlockSize, '\0');
+        if (!d->readFully(header.data(), BlockSize))
+            break;
+
+        if (header == QByteArray(BlockSize, '\0')) {
+            endOfArchive = true;
+            break;
+        }
+
+        const qint64 size = parseOctal(header.constData() + SizeOffset, SizeLength);
+        const char type = header.at(TypeOffset);
+        if (size < 0) {
+            d->ok = false;
+            break;
+        }
+
+        const bool extension = type == 'L' || type == 'x' || type == 'K' || type == 'g';
+        const bool regular = type == '0' || type == '\0' || type == '7';
+
+        QByteArray name;
+        if (regular) {
+            name = longName;
+            if (name.isEmpty())
+                name = paxPath;
+            if (name.isEmpty()) {
+                name = headerField(header, NameOffset, NameLength);
+                const QByteArray prefix = headerField(header, PrefixOffset, PrefixLength);
+                if (!prefix.isEmpty() && header.mid(MagicOffset, 5) == "ustar")
+                    name = prefix + '/' + name;
+            }
+            name = name.toLower();
+        }
+
+        // a pax size record would override the rewritten header field
+        const bool svg = name.endsWith(".svg");
+        const bool svgz = name.endsWith(".svgz");
+        const bool minify = (svg || svgz) && !paxSize && size <= MaximumMemberSize;
+        if (extension && size > MaximumMemberSize) {
+            d->ok = false;
+            break;
+        }
+
+        TarEntry entry;
+        entry.header = header;
+        const bool inMemory = extension || minify || size <= CopyThreshold;
+        if (inMemory) {
+            entry.data.resize(int(size));
+            if (!d->readFully(entry.data.data(), size)) {
+                d->ok = false;
+                break;
+            }
+            const qint64 padding = paddedSize(size) - size;
+            if (padding) {
+                char skipped[BlockSize];
+                if (!d->readFully(skipped, padding)) {
+                    d->ok = false;
+                    break;
+                }
+            }
+        } else {
+            // after everything queued before it
+            d->flush(0);
+            if (!d->copyEntry(header, size)) {
+                d->ok = false;
+                break;
+            }
+        }
+
+        if (type == 'L') {
+            // GNU long name for the next member
+            longName = entry.data;
+            const int end = longName.indexOf('\0');
+            if (end >= 0)
+                longName.truncate(end);
+        } else if (type == 'x') {
+            bool hasPath;
+            paxPath = paxRecord(entry.data, "path", &hasPath);
+            paxRecord(entry.data, "size", &paxSize);
+        } else if (regular) {
+            if (minify) {
+                entry.job = new MinifyJob(d->minifier, &d->mutex, &d->finished);
+                entry.job->data = entry.data;
+                entry.job->compressed = svgz || isGzipped(entry.data);
+                entry.data.clear();
+                ++d->pendingJobs;
+                pool->start(entry.job);
+            }
+
+            longName.clear();
+            paxPath.clear();
+            paxSize = false;
+        } else if (type != 'K' && type != 'g') {
+            longName.clear();
+            paxPath.clear();
+            paxSize = false;
+        }
+
+        if (!inMemory)
+            continue;
+        d->queue.append(entry);
+        d->flush(maxPendingJobs);
+    }
+
+    d->flush(0);
+
+    if (!endOfArchive)
+        d->ok = false;
+
+    // end-of-archive marker, padded to a full record like tar(1) does
+    const qint64 trailer = 2 * BlockSize + (RecordSize - (d->written + 2 * BlockSize) % RecordSize) % RecordSize;
+    d->outputDevice->write(QByteArray(int(trailer), '\0'));
+
+    if (standardInput.isOpen()) {
+        standardInput.close();
+        d->inputDevice = 0;
+    }
+    if (standardOutput.isOpen()) {
+        standardOutput.close();
+        d->outputDevice = 0;
+    }
+
+    return d->ok;
+}
@@ -0,0 +1,51 @@
+/*
+  SVGMin - Aggressive SVG minifier
+
+  Copyright (C) 2009 Ariya Hidayat (ariya.hidayat@gmail.com)
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#ifndef TARMINIFIER_H
+#define TARMINIFIER_H
+
+#include <QtCore/QIODevice>
+
+class SvgMinifier;
+
+// Reads a tar archive, minifies every .svg/.svgz member on the thread pool
+// and writes a tar archive with the same member order and metadata.
+// Any other member is copied verbatim.
+class TarMinifier
+{
+public:
+    TarMinifier(const SvgMinifier &minifier);
+    ~TarMinifier();
+
+    void setInputDevice(QIODevice *device);
+    void setOutputDevice(QIODevice *device);
+
+    bool run();
+
+private:
+    class Private;
+    Private *d;
+};
+
+#endif
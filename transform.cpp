@@ -0,0 +1,355 @@
+/*
+  SVGMin - Aggressive SVG minifier
+
+  Copyright (C) 2009 Ariya Hidayat (ariya.hidayat@gmail.com)
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include "transform.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "numberformat.h"
+
+static const double pi = 3.14159265358979323846;
+
+Transform Transform::translation(double tx, double ty)
+{
+    return Transform(1, 0, 0, 1, tx, ty);
+}
+
+Transform Transform::scaling(double sx, double sy)
+{
+    return Transform(sx, 0, 0, sy, 0, 0);
+}
+
+Transform Transform::rotation(double degrees)
+{
+    // exact for right angles, where cos() and sin() are off by an ulp
+    const double turns = degrees / 90;
+    if (turns == floor(turns)) {
+        switch (int(fmod(turns, 4) + 4) % 4) {
+        case 0: return Transform(1, 0, 0, 1, 0, 0);
+        case 1: return Transform(0, 1, -1, 0, 0, 0);
+        case 2: return Transform(-1, 0, 0, -1, 0, 0);
+        default: return Transform(0, -1, 1, 0, 0, 0);
+        }
+    }
+    const double angle = degrees * pi / 180;
+    const double cosine = cos(angle);
+    const double sine = sin(angle);
+    return Transform(cosine, sine, -sine, cosine, 0, 0);
+}
+
+Transform Transform::operator*(const Transform &o) const
+{
+    return Transform(a * o.a + c * o.b,
+                     b * o.a + d * o.b,
+                     a * o.c + c * o.d,
+                     b * o.c + d * o.d,
+                     a * o.e + c * o.f + e,
+                     b * o.e + d * o.f + f);
+}
+
+static inline bool isSpace(ushort c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f';
+}
+
+static void skipSeparators(const QChar *&pos, const QChar *end)
+{
+    while (pos < end && isSpace(pos->unicode()))
+        ++pos;
+    if (pos < end && pos->unicode() == ',')
+        ++pos;
+    while (pos < end && isSpace(pos->unicode()))
+        ++pos;
+}
+
+static bool startsWith(const QChar *pos, const QChar *end, const char *name, int length)
+{
+    if (end - pos < length)
+        return false;
+    for (int i = 0; i < length; ++i)
+        if (pos[i].unicode() != uchar(name[i]))
+            return false;
+    return true;
+}
+
+bool parseTransform(const QStringRef &text, Transform *transform)
+{
+    static const struct {
+        const char *name;
+        int minimum;
+        int maximum;
+    } functions[] = {
+        { "matrix", 6, 6 },
+        { "translate", 1, 2 },
+        { "scale", 1, 2 },
+        { "rotate", 1, 3 },
+        { "skewX", 1, 1 },
+        { "skewY", 1, 1 }
+    };
+
+    const QChar *pos = text.unicode();
+    const QChar *end = pos + text.size();
+    Transform result;
+
+    skipSeparators(pos, end);
+    if (pos == end)
+        return false;
+
+    while (pos < end) {
+        int function = -1;
+        for (int i = 0; i < 6; ++i) {
+            const int length = int(strlen(functions[i].name));
+            if (startsWith(pos, end, functions[i].name, length)) {
+                function = i;
+                pos += length;
+                break;
+            }
+        }
+        if (function < 0)
+            return false;
+
+        while (pos < end && isSpace(pos->unicode()))
+            ++pos;
+        if (pos == end || pos->unicode() != '(')
+            return false;
+        ++pos;
+
+        double args[6];
+        int count = 0;
+        for (;;) {
+            while (pos < end && isSpace(pos->unicode()))
+                ++pos;
+            if (pos < end && pos->unicode() == ')')
+                break;
+            if (count > 0)
+                skipSeparators(pos, end);
+            if (count == functions[function].maximum || !parseNumber(pos, end, &args[count]))
+                return false;
+            ++count;
+        }
+        ++pos;
+        if (count < functions[function].minimum)
+            return false;
+
+        Transform t;
+        switch (function) {
+        case 0:
+            t = Transform(args[0], args[1], args[2], args[3], args[4], args[5]);
+            break;
+        case 1:
+            t = Transform::translation(args[0], count > 1 ? args[1] : 0);
+            break;
+        case 2:
+            t = Transform::scaling(args[0], count > 1 ? args[1] : args[0]);
+            break;
+        case 3:
+            if (count == 2)
+                return false;
+            t = Transform::rotation(args[0]);
+            if (count == 3)
+                t = Transform::translation(args[1], args[2]) * t
+                    * Transform::translation(-args[1], -args[2]);
+            break;
+        case 4:
+            t = Transform(1, 0, tan(args[0] * pi / 180), 1, 0, 0);
+            break;
+        default:
+            t = Transform(1, tan(args[0] * pi / 180), 0, 1, 0, 0);
+            break;
+        }
+        result = result * t;
+
+        skipSeparators(pos, end);
+    }
+
+    *transform = result;
+    return true;
+}
+
+static void appendFunction(QString *text, const char *name, const double *args, int count)
+{
+    if (!text->isEmpty())
+        text->append(QLatin1Char(' '));
+    text->append(QLatin1String(name));
+    text->append(QLatin1Char('('));
+    appendNumbers(text, args, count, -1);
+    text->append(QLatin1Char(')'));
+}
+
+static void appendTranslate(QString *text, double tx, double ty)
+{
+    const double args[] = { tx, ty };
+    appendFunction(text, "translate", args, ty == 0 ? 1 : 2);
+}
+
+// equal up to rounding errors
+static inline bool sameValue(double x, double y)
+{
+    return fabs(x - y) <= 1e-12 * qMax(1.0, qMax(fabs(x), fabs(y)));
+}
+
+// the angle with the fewest decimals which gives the same rotation
+static bool rotationAngle(const Transform &t, double *degrees)
+{
+    const double angle = atan2(t.b, t.a) * 180 / pi;
+    for (int decimals = 0; decimals <= 12; ++decimals) {
+        const double candidate = roundNumber(angle, decimals);
+        const Transform r = Transform::rotation(candidate);
+        if (sameValue(r.a, t.a) && sameValue(r.b, t.b)
+            && sameValue(r.c, t.c) && sameValue(r.d, t.d)) {
+            *degrees = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+QString transformText(const Transform &t, int precision)
+{
+    // only the translation is a coordinate, an error in the other
+    // coefficients grows with the distance from the origin
+    const double e = roundNumber(t.e, precision);
+    const double f = roundNumber(t.f, precision);
+
+    QString shortest;
+    {
+        const double args[] = { t.a, t.b, t.c, t.d, e, f };
+        appendFunction(&shortest, "matrix", args, 6);
+    }
+
+    QString text;
+    if (t.b == 0 && t.c == 0) {
+        if (e != 0 || f != 0)
+            appendTranslate(&text, e, f);
+        if (t.a != 1 || t.d != 1) {
+            const double args[] = { t.a, t.d };
+            appendFunction(&text, "scale", args, t.a == t.d ? 1 : 2);
+        }
+        // the identity
+        if (text.isEmpty())
+            return text;
+    } else {
+        double degrees;
+        if (rotationAngle(t, &degrees)) {
+            if (e != 0 || f != 0)
+                appendTranslate(&text, e, f);
+            appendFunction(&text, "rotate", &degrees, 1);
+        }
+    }
+
+    if (!text.isEmpty() && text.size() <= shortest.size())
+        return text;
+    return shortest;
+}
+
+bool isTransformable(const QStringRef &name)
+{
+    static const char *const names[] = {
+        "a", "circle", "ellipse", "foreignObject", "g", "image", "line",
+        "path", "polygon", "polyline", "rect", "switch", "text", "use"
+    };
+    for (unsigned i = 0; i < sizeof(names) / sizeof(names[0]); ++i)
+        if (name == QLatin1String(names[i]))
+            return true;
+    return false;
+}
+
+static QString numberText(double value)
+{
+    QString text;
+    appendNumber(&text, value, -1);
+    return text;
+}
+
+static bool translatePoints(const QStringRef &value, double tx, double ty, QString *result)
+{
+    const QChar *pos = value.unicode();
+    const QChar *end = pos + value.size();
+    skipSeparators(pos, end);
+    for (int i = 0; pos < end; ++i) {
+        double number;
+        if (!parseNumber(pos, end, &number))
+            return false;
+        if (i > 0)
+            result->append(QLatin1Char(' '));
+        appendNumber(result, number + (i % 2 ? ty : tx), -1);
+        skipSeparators(pos, end);
+        // an odd number of coordinates is an error
+        if (pos == end && i % 2 == 0)
+            return false;
+    }
+    return true;
+}
+
+bool translateShape(const QStringRef &name, QXmlStreamAttributes *attributes,
+                    double tx, double ty)
+{
+    static const char *const position[] = { "x", "y", 0 };
+    static const char *const center[] = { "cx", "cy", 0 };
+    static const char *const line[] = { "x1", "y1", "x2", "y2", 0 };
+
+    if (name == QLatin1String("polygon") || name == QLatin1String("polyline")) {
+        QString points;
+        if (!translatePoints(attributes->value("points"), tx, ty, &points))
+            return false;
+        QXmlStreamAttributes result;
+        foreach (const QXmlStreamAttribute &attribute, *attributes)
+            if (attribute.qualifiedName() != QLatin1String("points"))
+                result += attribute;
+        result.append("points", points);
+        *attributes = result;
+        return true;
+    }
+
+    const char *const *names;
+    if (name == QLatin1String("rect") || name == QLatin1String("image") || name == QLatin1String("use"))
+        names = position;
+    else if (name == QLatin1String("circle") || name == QLatin1String("ellipse"))
+        names = center;
+    else if (name == QLatin1String("line"))
+        names = line;
+    else
+        return false;
+
+    // a missing coordinate is zero
+    QXmlStreamAttributes result;
+    foreach (const QXmlStreamAttribute &attribute, *attributes) {
+        bool coordinate = false;
+        for (int i = 0; names[i]; ++i)
+            coordinate = coordinate || attribute.qualifiedName() == QLatin1String(names[i]);
+        if (!coordinate)
+            result += attribute;
+    }
+    for (int i = 0; names[i]; ++i) {
+        const QString coordinateName = QLatin1String(names[i]);
+        double value = 0;
+        if (attributes->hasAttribute(coordinateName)
+            && !parseNumber(attributes->value(coordinateName), &value))
+            return false;
+        result.append(coordinateName, numberText(value + (i % 2 ? ty : tx)));
+    }
+    *attributes = result;
+    return true;
+}
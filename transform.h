@@ -0,0 +1,72 @@
+/*
+  SVGMin - Aggressive SVG minifier
+
+  Copyright (C) 2009 Ariya Hidayat (ariya.hidayat@gmail.com)
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#ifndef TRANSFORM_H
+#define TRANSFORM_H
+
+#include <QtCore/QString>
+#include <QtCore/QXmlStreamReader>
+
+// An affine transformation as in SVG, mapping (x, y) to
+// (a * x + c * y + e, b * x + d * y + f).
+struct Transform
+{
+    Transform() : a(1), b(0), c(0), d(1), e(0), f(0) {}
+    Transform(double xx, double yx, double xy, double yy, double dx, double dy)
+        : a(xx), b(yx), c(xy), d(yy), e(dx), f(dy) {}
+
+    static Transform translation(double tx, double ty);
+    static Transform scaling(double sx, double sy);
+    static Transform rotation(double degrees);
+
+    bool isIdentity() const { return isTranslation() && e == 0 && f == 0; }
+    bool isTranslation() const { return a == 1 && b == 0 && c == 0 && d == 1; }
+
+    // the transformation which applies other first and then this one,
+    // as in transform="this other"
+    Transform operator*(const Transform &other) const;
+
+    double a, b, c, d, e, f;
+};
+
+// Parses a transform list, returns false if it is not valid.
+bool parseTransform(const QStringRef &text, Transform *transform);
+
+// The shortest transform list for the transformation, using translate,
+// scale and rotate where they fit and matrix otherwise. The translation is
+// rounded to the given precision, the other coefficients are kept exactly.
+// Empty for the identity.
+QString transformText(const Transform &transform, int precision);
+
+// whether an element may carry a transform attribute which applies to
+// its own rendering
+bool isTransformable(const QStringRef &name);
+
+// Moves a basic shape, image or use element by (tx, ty) by changing its
+// coordinate attributes. Returns false and leaves the attributes alone if
+// the element has no such attributes or they are not plain numbers.
+bool translateShape(const QStringRef &name, QXmlStreamAttributes *attributes,
+                    double tx, double ty);
+
+#endif
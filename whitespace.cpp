@@ -0,0 +1,86 @@
+/*
+  SVGMin - Aggressive SVG minifier
+
+  Copyright (C) 2009 Ariya Hidayat (ariya.hidayat@gmail.com)
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include "whitespace.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+static inline bool isSpace(ushort c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+// the first space, tab or line break from pos on, eight UTF-16 code units
+// at a time where SSE2 is available
+static const QChar *findWhitespace(const QChar *pos, const QChar *end)
+{
+#ifdef __SSE2__
+    const __m128i space = _mm_set1_epi16(' ');
+    const __m128i tab = _mm_set1_epi16('\t');
+    const __m128i lineFeed = _mm_set1_epi16('\n');
+    const __m128i carriageReturn = _mm_set1_epi16('\r');
+    while (end - pos >= 8) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pos));
+        const __m128i matches = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi16(chunk, space), _mm_cmpeq_epi16(chunk, tab)),
+            _mm_or_si128(_mm_cmpeq_epi16(chunk, lineFeed), _mm_cmpeq_epi16(chunk, carriageReturn)));
+        const int mask = _mm_movemask_epi8(matches);
+        if (mask)
+            return pos + __builtin_ctz(mask) / 2;
+        pos += 8;
+    }
+#endif
+    while (pos < end && !isSpace(pos->unicode()))
+        ++pos;
+    return pos;
+}
+
+QString collapsedWhitespace(const QStringRef &text)
+{
+    const QChar *begin = text.unicode();
+    const QChar *end = begin + text.size();
+
+    QString result;
+    result.reserve(text.size());
+
+    const QChar *pos = begin;
+    while (pos < end) {
+        const QChar *run = findWhitespace(pos, end);
+        result.append(pos, int(run - pos));
+        if (run == end)
+            break;
+
+        bool lineBreaksOnly = true;
+        pos = run;
+        while (pos < end && isSpace(pos->unicode())) {
+            lineBreaksOnly = lineBreaksOnly && (pos->unicode() == '\n' || pos->unicode() == '\r');
+            ++pos;
+        }
+        result += QLatin1Char(lineBreaksOnly ? '\n' : ' ');
+    }
+
+    return result;
+}